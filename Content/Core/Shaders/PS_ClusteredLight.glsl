@@ -0,0 +1,97 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+/*-------------------------------------------------
+	Config
+/*-----------------------------------------------*/
+
+#version 150
+
+#define LIGHT_TEXELS		4
+#define LIGHTS_PER_ROW		256
+#define INDICES_PER_ROW		4096
+
+
+/*-------------------------------------------------
+	Input / Output
+/*-----------------------------------------------*/
+
+in vec2 oUv0;
+in vec3 oRay;
+
+out vec4 fragColour;
+
+uniform sampler2D Tex0;
+uniform sampler2D Tex1;
+uniform sampler2D LightData;
+uniform sampler2D ClusterGrid;
+uniform sampler2D LightIndex;
+
+uniform float farClipDistance;
+uniform vec4 clusterProj;		// Projection X and Y scale, X and Y offset
+uniform vec4 clusterGrid;		// Tile size, tile count in X and Y, slice count
+uniform vec4 clusterDepth;		// Near clip, slice scale, viewport size
+
+
+/*-------------------------------------------------
+	Shader
+/*-----------------------------------------------*/
+
+void main()
+{
+	vec4 a0 = texture(Tex0, oUv0); // Attribute 0: Diffuse color+shininess
+	vec4 a1 = texture(Tex1, oUv0); // Attribute 1: Normal+depth
+	if ((a1.w - 0.0001) < 0.0)
+		discard;
+
+	// Attributes
+	vec3 colour = a0.rgb;
+	float specularity = a0.a;
+	vec3 normal = a1.xyz;
+	vec3 viewPos = normalize(oRay) * a1.w * farClipDistance;
+	vec3 viewDir = -normalize(viewPos);
+
+	// Cluster of this pixel, with the same projection as the CPU binning
+	float depth = -viewPos.z;
+	vec2 ndc = clusterProj.xy * viewPos.xy / depth - clusterProj.zw;
+	vec2 tile = clamp(floor((ndc * 0.5 + 0.5) * clusterDepth.zw / clusterGrid.x), vec2(0.0), clusterGrid.yz - 1.0);
+	float slice = clamp(floor(log(depth / clusterDepth.x) * clusterDepth.y), 0.0, clusterGrid.w - 1.0);
+	vec4 cluster = texelFetch(ClusterGrid, ivec2(tile.x, tile.y + slice * clusterGrid.z), 0);
+	int offset = int(cluster.x);
+	int count = int(cluster.y);
+
+	// Light loop
+	vec3 total_light_contrib = vec3(0.0);
+	for (int i = 0; i < count; i++)
+	{
+		int index = offset + i;
+		int light = int(texelFetch(LightIndex, ivec2(index % INDICES_PER_ROW, index / INDICES_PER_ROW), 0).r);
+		ivec2 base = ivec2((light % LIGHTS_PER_ROW) * LIGHT_TEXELS, light / LIGHTS_PER_ROW);
+
+		// Light direction and distance, clipped at the light radius
+		vec4 lightPos = texelFetch(LightData, base, 0);
+		vec3 objToLightVec = lightPos.xyz - viewPos;
+		float len_sq = dot(objToLightVec, objToLightVec);
+		if (len_sq > lightPos.w * lightPos.w)
+			continue;
+		float len = sqrt(len_sq);
+		vec3 objToLightDir = objToLightVec / len;
+
+		// Diffuse and specular
+		vec3 lightDiffuseColor = texelFetch(LightData, base + ivec2(1, 0), 0).rgb;
+		vec3 lightSpecularColor = texelFetch(LightData, base + ivec2(2, 0), 0).rgb;
+		vec3 light_contrib = max(0.0, dot(objToLightDir, normal)) * lightDiffuseColor;
+		vec3 h = normalize(viewDir + objToLightDir);
+		light_contrib += specularity * pow(max(dot(normal, h), 0.0), 32.0) * lightSpecularColor;
+
+		// Attenuation
+		vec3 lightFalloff = texelFetch(LightData, base + ivec2(3, 0), 0).xyz;
+		total_light_contrib += light_contrib / dot(lightFalloff, vec3(1.0, len, len_sq));
+	}
+
+	fragColour = vec4(total_light_contrib * colour, 0.0);
+}
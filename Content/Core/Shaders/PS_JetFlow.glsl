@@ -13,7 +13,13 @@
 
 uniform float		baseStrength;
 uniform float		basePower;
+// Instanced : alpha from the custom parameter 1 of the instance
+#ifdef INSTANCED
+in vec4				vCustom1;
+#define baseAlpha	vCustom1
+#else
 uniform vec4		baseAlpha;
+#endif
 
 uniform float		panningX;
 uniform float		panningY;
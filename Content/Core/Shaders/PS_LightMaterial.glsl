@@ -22,6 +22,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define LIGHT_POINT         1
 #define LIGHT_SPOT          2
 #define LIGHT_DIRECTIONAL   3
+#define SHADOW_CASCADES     4
 
 //////////////////////////////////////////////////////////////////////////////
 // Helper function section
@@ -33,6 +34,7 @@ void checkShadow(
     vec3 viewPos,
     mat4 invView,
     mat4 shadowViewProj,
+    vec4 shadowTile,
     float shadowFarClip,
 #if LIGHT_TYPE == LIGHT_DIRECTIONAL
     vec3 shadowCamPos
@@ -47,7 +49,9 @@ void checkShadow(
 #endif
     vec4 shadowProjPos = shadowViewProj * vec4(worldPos,1);
     shadowProjPos /= shadowProjPos.w;
-    vec2 shadowSampleTexCoord = shadowProjPos.xy;
+    // Stay half a texel inside the tile so that the neighbouring tiles are never sampled
+    vec2 tileBorder = 0.5 / (shadowTile.zw * vec2(textureSize(shadowMap, 0)));
+    vec2 shadowSampleTexCoord = shadowTile.xy + clamp(shadowProjPos.xy, tileBorder, 1.0 - tileBorder) * shadowTile.zw;
     float shadowDepth = texture(shadowMap, shadowSampleTexCoord).r;
     float shadowDistance = shadowDepth * shadowFarClip;
     if((shadowDistance - distanceFromLight + 0.1) < 0.0)
@@ -85,11 +89,19 @@ uniform float flip;
 
 #ifdef IS_SHADOW_CASTER
 uniform mat4 invView;
-uniform mat4 shadowViewProjMat;
 uniform sampler2D ShadowTex;
-uniform vec3 shadowCamPos;
+#if LIGHT_TYPE == LIGHT_DIRECTIONAL
+// Per cascade : texture matrix, atlas tile, camera position and far clip, end distance
+uniform mat4 shadowCascadeMat[SHADOW_CASCADES];
+uniform vec4 shadowCascadeTile[SHADOW_CASCADES];
+uniform vec4 shadowCascadePos[SHADOW_CASCADES];
+uniform vec4 shadowCascadeSplits;
+#else
+uniform mat4 shadowViewProjMat;
+uniform vec4 shadowTile;
 uniform float shadowFarClip;
 #endif
+#endif
 
 uniform float farClipDistance;
 // Attributes of light
@@ -134,9 +146,19 @@ void main()
 
 #ifdef IS_SHADOW_CASTER
     #if LIGHT_TYPE == LIGHT_DIRECTIONAL
-        checkShadow(ShadowTex, viewPos, invView, shadowViewProjMat, shadowFarClip, shadowCamPos);
+        // Cascade by view depth, no shadow past the last one
+        float viewDepth = -viewPos.z;
+        int cascade = 0;
+        for (int i = 0; i < SHADOW_CASCADES - 1; i++)
+        {
+            if (viewDepth > shadowCascadeSplits[i])
+                cascade = i + 1;
+        }
+        if (viewDepth <= shadowCascadeSplits[SHADOW_CASCADES - 1])
+            checkShadow(ShadowTex, viewPos, invView, shadowCascadeMat[cascade], shadowCascadeTile[cascade],
+                shadowCascadePos[cascade].w, shadowCascadePos[cascade].xyz);
     #else
-        checkShadow(ShadowTex, viewPos, invView, shadowViewProjMat, shadowFarClip, len);
+        checkShadow(ShadowTex, viewPos, invView, shadowViewProjMat, shadowTile, shadowFarClip, len);
     #endif
 #endif
     
@@ -29,9 +29,19 @@ out vec3 oTangent;
 out vec3 oBiNormal;
 out vec2 oUv0;
 
+uniform vec3 cEyePosition;
+
+// Instanced : world matrix rows in uv1 - uv3, world space camera
+#ifdef INSTANCED
+in vec4 uv1;
+in vec4 uv2;
+in vec4 uv3;
+uniform mat4 cViewProj;
+uniform mat4 cView;
+#else
 uniform mat4 cWorldViewProj;
 uniform mat4 cWorldView;
-uniform vec3 cEyePosition;
+#endif
 
 
 /*-------------------------------------------------
@@ -40,11 +50,22 @@ uniform vec3 cEyePosition;
 
 void main()
 {
+#ifdef INSTANCED
+	mat4 world = mat4(uv1, uv2, uv3, vec4(0, 0, 0, 1));
+	vec4 worldPos = vertex * world;
+	gl_Position = cViewProj * worldPos;
+	oNormal = (cView * (vec4(normal,0) * world)).xyz;
+	oTangent = (cView * (vec4(tangent,0) * world)).xyz;
+	oBiNormal =(cView * (vec4(binormal,0) * world)).xyz;
+	oViewPos = (cView * worldPos).xyz;
+	oViewDir = worldPos.xyz - cEyePosition;
+#else
 	gl_Position = cWorldViewProj * vertex;
 	oNormal = (cWorldView * vec4(normal,0)).xyz;
 	oTangent = (cWorldView * vec4(tangent,0)).xyz;
 	oBiNormal =(cWorldView * vec4(binormal,0)).xyz;
 	oViewPos = (cWorldView * vertex).xyz;
 	oViewDir = vertex.xyz - cEyePosition;
+#endif
 	oUv0 = uv0;
 }
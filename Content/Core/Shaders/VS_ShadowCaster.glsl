@@ -25,11 +25,25 @@ in vec4 vertex;
     
 out vec3 oViewPos;
    
+#ifdef INSTANCED
+in vec4 uv1;
+in vec4 uv2;
+in vec4 uv3;
+uniform mat4 cViewProj;
+uniform mat4 cView;
+#else
 uniform mat4 cWorldViewProj;
 uniform mat4 cWorldView;
+#endif
 
 void main()
 {
+#ifdef INSTANCED
+    vec4 worldPos = vertex * mat4(uv1, uv2, uv3, vec4(0, 0, 0, 1));
+    gl_Position = cViewProj * worldPos;
+    oViewPos = (cView * worldPos).xyz;
+#else
     gl_Position = cWorldViewProj * vertex;
     oViewPos = (cWorldView * vertex).xyz;
+#endif
 }
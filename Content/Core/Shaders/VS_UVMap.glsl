@@ -11,7 +11,12 @@
 
 #version 150
 
+// Instanced : world matrix rows in uv1 - uv3, custom parameters from uv4
+#ifdef INSTANCED
+uniform mat4 viewProjection;
+#else
 uniform mat4 projection;
+#endif
 
 
 /*-------------------------------------------------
@@ -23,6 +28,14 @@ in vec2 uv0;
 
 out vec2 vUv0;
 
+#ifdef INSTANCED
+in vec4 uv1;
+in vec4 uv2;
+in vec4 uv3;
+in vec4 uv5;
+out vec4 vCustom1;
+#endif
+
 
 /*-------------------------------------------------
 	Shader
@@ -31,5 +44,11 @@ out vec2 vUv0;
 void main()
 {
 	vUv0 = uv0;
+#ifdef INSTANCED
+	mat4 world = mat4(uv1, uv2, uv3, vec4(0, 0, 0, 1));
+	gl_Position = viewProjection * (vertex * world);
+	vCustom1 = uv5;
+#else
 	gl_Position = projection * vertex;
+#endif
 }
@@ -25,7 +25,8 @@ void Editor::rotateLights(Ogre::Degree pitch, Ogre::Degree roll)
 void Editor::construct()
 {
 	// Lighting and background
-	new MeshActor(this, "Background", "testbed.mesh", "Default");
+	MeshActor* background = new MeshActor(this, "Background", "testbed.mesh", "Default");
+	background->setStatic(true);
 	Ogre::Light* l1 = mScene->createLight();
     l1->setType(Ogre::Light::LT_DIRECTIONAL);
     l1->setDiffuseColour(1.95f, 1.95f, 1.95f);
@@ -36,6 +37,7 @@ void Editor::construct()
 
 	MeshActor* sphere = new MeshActor(this, "dbgdbgAAA", "teapot.mesh", "AAA");
 	sphere->setScale(0.5f);
+	sphere->setStatic(true);
 
 
 
@@ -57,6 +59,7 @@ void Editor::construct()
 			MeshActor* sphere = new MeshActor(this, "Sphere_" + Ogre::StringConverter::toString(i), "teapot.mesh", matName);
 			sphere->translate(Vector3(i * mSphereGap, 0, 0));
 			sphere->setScale(0.5f);
+			sphere->setStatic(true);
 			mSpheres.push_back(sphere);
 			i++;
 		}
@@ -17,6 +17,7 @@ Class definitions
 User::User(Editor* g, String name) : Player(g, name)
 {
 	mEditor = g;
+	addTickGroups(TG_MAIN);
 	bMeshTurning = false;
 	bLightsTurning = false;
 
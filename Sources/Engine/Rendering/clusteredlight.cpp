@@ -0,0 +1,270 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#include "Engine/Rendering/clusteredlight.hpp"
+#include "Engine/Rendering/deferredlight.hpp"
+#include "Engine/Rendering/geometry.hpp"
+
+#define LIGHT_TEXELS		4
+#define LIGHTS_PER_ROW		256
+#define INDICES_PER_ROW		4096
+
+
+/*----------------------------------------------
+	Constructor & destructor
+----------------------------------------------*/
+
+ClusteredLight::ClusteredLight(int tileSize, int slices, int maxLights, int maxIndices)
+	: mTileSize(tileSize), mMaxLights(maxLights), mMaxIndices(maxIndices), mCluster(tileSize, slices, maxIndices)
+{
+	setRenderQueueGroup(Ogre::RENDER_QUEUE_2);
+
+	// Render op setup
+	mRenderOp.vertexData = new Ogre::VertexData();
+	mRenderOp.indexData = 0;
+	GeomUtils::createQuad(mRenderOp.vertexData);
+	mRenderOp.operationType = Ogre::RenderOperation::OT_TRIANGLE_STRIP;
+	mRenderOp.useIndexes = false;
+
+	// Set bounding box (pretty much infinite)
+	setBoundingBox(Ogre::AxisAlignedBox(-10000,-10000,-10000,10000,10000,10000));
+	mRadius = 15000;
+
+	// Light and index textures, the grid follows the viewport size
+	static int sInstanceCount = 0;
+	mBaseName = "Cluster/" + Ogre::StringConverter::toString(sInstanceCount++) + "/";
+	mTilesX = 0;
+	mTilesY = 0;
+	int lightRows = (mMaxLights + LIGHTS_PER_ROW - 1) / LIGHTS_PER_ROW;
+	int indexRows = (mMaxIndices + INDICES_PER_ROW - 1) / INDICES_PER_ROW;
+	mLightTex = createTexture(mBaseName + "Lights", LIGHTS_PER_ROW * LIGHT_TEXELS, lightRows, Ogre::PF_FLOAT32_RGBA);
+	mIndexTex = createTexture(mBaseName + "Indices", INDICES_PER_ROW, indexRows, Ogre::PF_FLOAT32_R);
+
+	// Clustered lighting material
+	mMatPtr = Ogre::MaterialManager::getSingleton().getByName("Render/ClusteredLight");
+	assert(mMatPtr.isNull() == false);
+	mMatPtr->load();
+	Ogre::Pass* pass = mMatPtr->getTechnique(0)->getPass(0);
+	pass->getTextureUnitState("LightData")->setTextureName(mLightTex->getName());
+	pass->getTextureUnitState("LightIndex")->setTextureName(mIndexTex->getName());
+
+	// Explicitly bind samplers for OpenGL
+	if (Ogre::Root::getSingleton().getRenderSystem()->getName().find("OpenGL 3+") != Ogre::String::npos)
+	{
+		Ogre::GpuProgramParametersSharedPtr params = pass->getFragmentProgramParameters();
+		params->setNamedConstant("Tex0", 0);
+		params->setNamedConstant("Tex1", 1);
+		params->setNamedConstant("LightData", 2);
+		params->setNamedConstant("ClusterGrid", 3);
+		params->setNamedConstant("LightIndex", 4);
+	}
+}
+
+
+ClusteredLight::~ClusteredLight()
+{
+	delete mRenderOp.indexData;
+	delete mRenderOp.vertexData;
+
+	Ogre::TextureManager::getSingleton().remove(mLightTex->getName());
+	Ogre::TextureManager::getSingleton().remove(mIndexTex->getName());
+	if (!mGridTex.isNull())
+	{
+		Ogre::TextureManager::getSingleton().remove(mGridTex->getName());
+	}
+}
+
+
+/*----------------------------------------------
+	Lights
+----------------------------------------------*/
+
+bool ClusteredLight::isClustered(Ogre::Light* light)
+{
+	return (light->getType() == Ogre::Light::LT_POINT);
+}
+
+
+void ClusteredLight::clear()
+{
+	mSceneLights.clear();
+}
+
+
+void ClusteredLight::addLight(Ogre::Light* light)
+{
+	if ((int)mSceneLights.size() < mMaxLights)
+	{
+		mSceneLights.push_back(light);
+	}
+}
+
+
+size_t ClusteredLight::getLightCount()
+{
+	return mSceneLights.size();
+}
+
+
+void ClusteredLight::updateFromCamera(Ogre::Camera* camera)
+{
+	Ogre::Viewport* vp = camera->getViewport();
+	int width = vp->getActualWidth();
+	int height = vp->getActualHeight();
+
+	// The projection is given without render target flipping so the CPU and GPU tiles match
+	const Ogre::Matrix4& proj = camera->getProjectionMatrix();
+	mCluster.setFrustum(width, height, proj, camera->getNearClipDistance(), camera->getFarClipDistance());
+
+	// New grid for a new viewport size
+	if (mCluster.getTilesX() != mTilesX || mCluster.getTilesY() != mTilesY)
+	{
+		if (!mGridTex.isNull())
+		{
+			Ogre::TextureManager::getSingleton().remove(mGridTex->getName());
+		}
+		mTilesX = mCluster.getTilesX();
+		mTilesY = mCluster.getTilesY();
+		mGridTex = createTexture(mBaseName + "Grid", mTilesX, mTilesY * mCluster.getSlices(), Ogre::PF_FLOAT32_RGBA);
+		mMatPtr->getTechnique(0)->getPass(0)->getTextureUnitState("ClusterGrid")->setTextureName(mGridTex->getName());
+	}
+
+	binLights(camera);
+	upload();
+
+	// Shader parameters
+	Ogre::Vector3 farCorner = camera->getViewMatrix(true) * camera->getWorldSpaceCorners()[4];
+	Ogre::Pass* pass = mMatPtr->getTechnique(0)->getPass(0);
+	pass->getVertexProgramParameters()->setNamedConstant("farCorner", farCorner);
+	Ogre::GpuProgramParametersSharedPtr params = pass->getFragmentProgramParameters();
+	params->setNamedConstant("clusterProj", Ogre::Vector4(proj[0][0], proj[1][1], proj[0][2], proj[1][2]));
+	params->setNamedConstant("clusterGrid", Ogre::Vector4(mTileSize, mTilesX, mTilesY, mCluster.getSlices()));
+	params->setNamedConstant("clusterDepth", Ogre::Vector4(camera->getNearClipDistance(), mCluster.getSliceScale(), width, height));
+}
+
+
+/*----------------------------------------------
+	Renderable
+----------------------------------------------*/
+
+Ogre::Real ClusteredLight::getBoundingRadius(void) const
+{
+	return mRadius;
+}
+
+
+Ogre::Real ClusteredLight::getSquaredViewDepth(const Ogre::Camera*) const
+{
+	return 0.0;
+}
+
+
+const Ogre::MaterialPtr& ClusteredLight::getMaterial(void) const
+{
+	return mMatPtr;
+}
+
+
+void ClusteredLight::getWorldTransforms(Ogre::Matrix4* xform) const
+{
+	*xform = Ogre::Matrix4::IDENTITY;
+}
+
+
+/*----------------------------------------------
+	Binning
+----------------------------------------------*/
+
+Ogre::TexturePtr ClusteredLight::createTexture(Ogre::String name, int width, int height, Ogre::PixelFormat format)
+{
+	return Ogre::TextureManager::getSingleton().createManual(name,
+		Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+		Ogre::TEX_TYPE_2D, width, height, 0, format,
+		Ogre::TU_DYNAMIC_WRITE_ONLY_DISCARDABLE);
+}
+
+
+void ClusteredLight::binLights(Ogre::Camera* camera)
+{
+	const Ogre::Matrix4& view = camera->getViewMatrix(true);
+	size_t lightCount = mSceneLights.size();
+	mLightData.resize(lightCount * LIGHT_TEXELS);
+	mCluster.clear();
+
+	// Light data, in the cluster order
+	for (size_t i = 0; i < lightCount; i++)
+	{
+		Ogre::Light* light = mSceneLights[i];
+		Ogre::Vector3 pos = view * light->getDerivedPosition();
+		Ogre::Real radius = LightCluster::getLightRadius(light);
+		Ogre::ColourValue diffuse = light->getDiffuseColour();
+		Ogre::ColourValue specular = light->getSpecularColour();
+		mLightData[i * LIGHT_TEXELS + 0] = Ogre::Vector4(pos.x, pos.y, pos.z, radius);
+		mLightData[i * LIGHT_TEXELS + 1] = Ogre::Vector4(diffuse.r, diffuse.g, diffuse.b, 0);
+		mLightData[i * LIGHT_TEXELS + 2] = Ogre::Vector4(specular.r, specular.g, specular.b, 0);
+		mLightData[i * LIGHT_TEXELS + 3] = Ogre::Vector4(light->getAttenuationConstant(),
+			light->getAttenuationLinear(), light->getAttenuationQuadric(), 0);
+		mCluster.addLight(pos, radius);
+	}
+
+	mCluster.build();
+}
+
+
+void ClusteredLight::upload()
+{
+	// Light data
+	Ogre::HardwarePixelBufferSharedPtr buffer = mLightTex->getBuffer();
+	buffer->lock(Ogre::HardwareBuffer::HBL_DISCARD);
+	const Ogre::PixelBox& lights = buffer->getCurrentLock();
+	float* data = static_cast<float*>(lights.data);
+	for (size_t i = 0; i < mSceneLights.size(); i++)
+	{
+		float* texel = data + (i / LIGHTS_PER_ROW) * lights.rowPitch * 4 + (i % LIGHTS_PER_ROW) * LIGHT_TEXELS * 4;
+		memcpy(texel, mLightData[i * LIGHT_TEXELS].ptr(), LIGHT_TEXELS * 4 * sizeof(float));
+	}
+	buffer->unlock();
+
+	// Cluster grid : offset and count per cluster
+	buffer = mGridTex->getBuffer();
+	buffer->lock(Ogre::HardwareBuffer::HBL_DISCARD);
+	const Ogre::PixelBox& grid = buffer->getCurrentLock();
+	data = static_cast<float*>(grid.data);
+	const int* offsets = mCluster.getOffsets();
+	const int* counts = mCluster.getCounts();
+	for (int row = 0; row < mTilesY * mCluster.getSlices(); row++)
+	{
+		float* texel = data + row * grid.rowPitch * 4;
+		for (int x = 0; x < mTilesX; x++)
+		{
+			int c = row * mTilesX + x;
+			texel[4 * x + 0] = (float)offsets[c];
+			texel[4 * x + 1] = (float)counts[c];
+			texel[4 * x + 2] = 0;
+			texel[4 * x + 3] = 0;
+		}
+	}
+	buffer->unlock();
+
+	// Light indices, only the used rows
+	buffer = mIndexTex->getBuffer();
+	buffer->lock(Ogre::HardwareBuffer::HBL_DISCARD);
+	const Ogre::PixelBox& indices = buffer->getCurrentLock();
+	data = static_cast<float*>(indices.data);
+	const int* lightIndices = mCluster.getIndices();
+	int indexCount = mCluster.getIndexCount();
+	for (int row = 0; row * INDICES_PER_ROW < indexCount; row++)
+	{
+		float* texel = data + row * indices.rowPitch;
+		int count = std::min(INDICES_PER_ROW, indexCount - row * INDICES_PER_ROW);
+		for (int i = 0; i < count; i++)
+		{
+			texel[i] = (float)lightIndices[row * INDICES_PER_ROW + i];
+		}
+	}
+	buffer->unlock();
+}
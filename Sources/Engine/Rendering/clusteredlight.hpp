@@ -0,0 +1,148 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#ifndef _CLUSTERED_LIGHT_H
+#define _CLUSTERED_LIGHT_H
+
+
+#include "Engine/Rendering/renderer.hpp"
+#include "Engine/Rendering/lightcluster.hpp"
+
+
+/*----------------------------------------------
+	Clustered point lighting
+----------------------------------------------*/
+
+/**
+ * Point lights are binned on the CPU by a LightCluster, then shaded together by
+ * a single fullscreen pass. The light data, the cluster grid and the light index
+ * lists are uploaded as float textures.
+ **/
+class ClusteredLight : public Ogre::SimpleRenderable
+{
+
+public:
+
+	/**
+	 * @brief Clustered lighting constructor
+	 * @param tileSize		Tile size in pixels
+	 * @param slices		Depth slice count
+	 * @param maxLights		Light capacity
+	 * @param maxIndices	Light index capacity over all clusters
+	 **/
+	ClusteredLight(int tileSize, int slices, int maxLights, int maxIndices);
+
+	/**
+	 * @brief Clustered lighting destructor
+	 **/
+	~ClusteredLight();
+
+	/**
+	 * @brief Check if a light is shaded by the clusters
+	 * @param light			Scene light
+	 * @return true for point lights
+	 **/
+	static bool isClustered(Ogre::Light* light);
+
+	/**
+	 * @brief Remove all lights, before a new frame
+	 **/
+	void clear();
+
+	/**
+	 * @brief Add a light for this frame
+	 * @param light			Scene light
+	 **/
+	void addLight(Ogre::Light* light);
+
+	/**
+	 * @brief Get the number of lights in this frame
+	 * @return the light count
+	 **/
+	size_t getLightCount();
+
+	/**
+	 * @brief Bin the lights and upload the cluster data
+	 * @param camera		Camera to use
+	 **/
+	void updateFromCamera(Ogre::Camera* camera);
+
+	/**
+	 * @brief Get the light radius
+	 * @return the max effective distance
+	 **/
+	virtual Ogre::Real getBoundingRadius(void) const;
+
+	/**
+	 * @brief Get the view depth (zero)
+	 * @param cam			Ignored
+	 * @return zero
+	 **/
+	virtual Ogre::Real getSquaredViewDepth(const Ogre::Camera* cam) const;
+
+	/**
+	 * @brief Get the current material
+	 * @return a pointer to the material
+	 **/
+	virtual const Ogre::MaterialPtr& getMaterial(void) const;
+
+	/**
+	 * @brief Get the world transformation
+	 * @param xform			Transformation matrix to build
+	 **/
+	virtual void getWorldTransforms(Ogre::Matrix4* xform) const;
+
+
+protected:
+
+	/**
+	 * @brief Create a dynamic float texture
+	 * @param name			Texture name
+	 * @param width			Width in texels
+	 * @param height		Height in texels
+	 * @param format		Pixel format
+	 * @return the texture
+	 **/
+	Ogre::TexturePtr createTexture(Ogre::String name, int width, int height, Ogre::PixelFormat format);
+
+	/**
+	 * @brief Build the light data and bin the lights
+	 * @param camera		Camera to use
+	 **/
+	void binLights(Ogre::Camera* camera);
+
+	/**
+	 * @brief Upload the light data, the grid and the index lists
+	 **/
+	void upload();
+
+	// Settings
+	int mTileSize;
+	int mMaxLights;
+	int mMaxIndices;
+
+	// Grid texture size for the current viewport
+	int mTilesX;
+	int mTilesY;
+
+	// Frame data
+	LightCluster mCluster;
+	Ogre::vector<Ogre::Light*>::type mSceneLights;
+	Ogre::vector<Ogre::Vector4>::type mLightData;
+
+	// Render data, named after the instance as compositors can recreate it
+	Ogre::String mBaseName;
+	Ogre::TexturePtr mLightTex;
+	Ogre::TexturePtr mGridTex;
+	Ogre::TexturePtr mIndexTex;
+	Ogre::MaterialPtr mMatPtr;
+	Ogre::Real mRadius;
+
+};
+
+
+#endif
@@ -45,23 +45,41 @@ DeferredLight::~DeferredLight()
 
 void DeferredLight::setAttenuation(float c, float b, float a)
 {
-	float outerRadius = mParentLight->getAttenuationRange();
 	if (c != 1.0f || b != 0.0f || a != 0.0f)
 	{
 		ENABLE_BIT(mPermutation, LightMaterialGenerator::MI_ATTENUATED);
-		if (mParentLight->getType() == Ogre::Light::LT_POINT)
-		{
-			float minAttenuation = 1.0f / (MINIMUM_ATTENUATION / 256.0f);
-			c -= minAttenuation;
-			outerRadius = (-2 * c) / (b + sqrt(b * b - 4 * a * c));
-		}
 	}
 	else
 	{
 		DISABLE_BIT(mPermutation,LightMaterialGenerator::MI_ATTENUATED);
 	}
     
-	rebuildGeometry(outerRadius);
+	rebuildGeometry(getAttenuationRadius(mParentLight));
+}
+
+
+float DeferredLight::getAttenuationRadius(Ogre::Light* light)
+{
+	float c = light->getAttenuationConstant();
+	float b = light->getAttenuationLinear();
+	float a = light->getAttenuationQuadric();
+	float outerRadius = light->getAttenuationRange();
+
+	// Point lights end where the attenuation reaches the minimum
+	if ((c != 1.0f || b != 0.0f || a != 0.0f) && light->getType() == Ogre::Light::LT_POINT)
+	{
+		float minAttenuation = 1.0f / (MINIMUM_ATTENUATION / 256.0f);
+		c -= minAttenuation;
+		outerRadius = (-2 * c) / (b + sqrt(b * b - 4 * a * c));
+	}
+	return outerRadius;
+}
+
+
+bool DeferredLight::isCameraInsideSphere(const Ogre::Vector3& cameraPos, const Ogre::Vector3& lightPos,
+	Ogre::Real radius, Ogre::Real nearClip)
+{
+	return cameraPos.distance(lightPos) <= radius + nearClip + 0.1;
 }
 
 
@@ -240,8 +258,8 @@ bool DeferredLight::isCameraInsideLight(Ogre::Camera* camera)
 
 	case Ogre::Light::LT_POINT:
 		{
-			Ogre::Real distanceFromLight = camera->getDerivedPosition().distance(mParentLight->getDerivedPosition());
-			return distanceFromLight <= mRadius + camera->getNearClipDistance() + 0.1;
+			return isCameraInsideSphere(camera->getDerivedPosition(), mParentLight->getDerivedPosition(),
+				mRadius, camera->getNearClipDistance());
 		}
 
 	case Ogre::Light::LT_SPOTLIGHT:
@@ -322,22 +340,5 @@ void DeferredLight::updateFromCamera(Ogre::Camera* camera)
 				pass->setDepthFunction(Ogre::CMPF_LESS_EQUAL);
 			}
 		}
-
-		Ogre::Camera shadowCam("ShadowCameraSetupCam", 0);
-		shadowCam._notifyViewport(camera->getViewport());
-		Ogre::SceneManager* sm = mParentLight->_getManager();
-		sm->getShadowCameraSetup()->getShadowCamera(sm, 
-			camera, camera->getViewport(), mParentLight, &shadowCam, 0);
-			
-		//Get the shadow camera position
-		if (params->_findNamedConstantDefinition("shadowCamPos")) 
-		{
-			params->setNamedConstant("shadowCamPos", shadowCam.getPosition());
-		}
-		if (params->_findNamedConstantDefinition("shadowFarClip"))
-		{
-			params->setNamedConstant("shadowFarClip", shadowCam.getFarClipDistance());
-		}
-
 	}
 }
@@ -46,6 +46,24 @@ public:
 	 **/
 	void updateFromCamera(Ogre::Camera* camera);
 	
+	/**
+	 * @brief Get the distance where a light stops contributing
+	 * @param light			Ogre light
+	 * @return the light geometry radius
+	 **/
+	static float getAttenuationRadius(Ogre::Light* light);
+	
+	/**
+	 * @brief Is a camera inside a light sphere, counting the near clip distance ?
+	 * @param cameraPos		Camera position
+	 * @param lightPos		Light position
+	 * @param radius		Light radius
+	 * @param nearClip		Camera near clip distance
+	 * @return true if it is
+	 **/
+	static bool isCameraInsideSphere(const Ogre::Vector3& cameraPos, const Ogre::Vector3& lightPos,
+		Ogre::Real radius, Ogre::Real nearClip);
+	
 	/**
 	 * @brief Do we cast shadows
 	 * @return true if shadows
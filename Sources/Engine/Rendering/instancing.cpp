@@ -0,0 +1,203 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#include "Engine/Rendering/instancing.hpp"
+
+#define INSTANCED_SUFFIX			"/Instanced"
+#define INSTANCED_SHADOW_CASTER		"Render/ShadowCaster/Instanced"
+
+
+/*----------------------------------------------
+	Constructor & destructor
+----------------------------------------------*/
+
+InstanceCache::InstanceCache(Ogre::SceneManager* sm, tinyxml2::XMLElement* s)
+	: mScene(sm)
+{
+	// XML settings
+	tinyxml2::XMLElement* config = s->FirstChildElement("renderer");
+	assert(config != NULL);
+	bEnabled = config->FirstChildElement("instancing")->BoolAttribute("value");
+	mBatchSize = config->FirstChildElement("instancesPerBatch")->IntAttribute("value");
+	mInstanceCount = 0;
+
+	// Vertex buffer instancing is required for the basic hardware technique
+	const Ogre::RenderSystemCapabilities* caps = Ogre::Root::getSingleton().getRenderSystem()->getCapabilities();
+	if (bEnabled && !caps->hasCapability(Ogre::RSC_VERTEX_BUFFER_INSTANCE_DATA))
+	{
+		Ogre::LogManager::getSingleton().logMessage("InstanceCache : no instance data support, instancing disabled");
+		bEnabled = false;
+	}
+
+	// Instanced program variants, passes without vertex program get a position-only one
+	mVertexPrograms[""] = "VS_Instanced";
+	mVertexPrograms["VS_Master"] = "VS_Master_Instanced";
+	mVertexPrograms["VS_UVMap"] = "VS_UVMap_Instanced";
+	mFragmentPrograms["PS_JetFlow"] = "PS_JetFlow_Instanced";
+}
+
+
+InstanceCache::~InstanceCache()
+{
+	Ogre::map<String, Ogre::InstanceManager*>::type::iterator it;
+	for (it = mManagers.begin(); it != mManagers.end(); it++)
+	{
+		mScene->destroyInstanceManager(it->second);
+	}
+}
+
+
+/*----------------------------------------------
+	Instances
+----------------------------------------------*/
+
+Ogre::InstancedEntity* InstanceCache::create(String file, String material, bool bCastShadows)
+{
+	if (!bEnabled || !isInstanceable(file))
+	{
+		return NULL;
+	}
+	String instancedMaterial = getInstancedMaterial(material);
+	if (instancedMaterial == "")
+	{
+		return NULL;
+	}
+
+	// One manager per mesh, material and shadow setting
+	String key = file + "|" + instancedMaterial + "|" + StringConverter::toString(bCastShadows);
+	if (mManagers.find(key) == mManagers.end())
+	{
+		Ogre::InstanceManager* manager = mScene->createInstanceManager(key, file,
+			Ogre::ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME,
+			Ogre::InstanceManager::HWInstancingBasic, mBatchSize);
+		manager->setNumCustomParams(INSTANCE_CUSTOM_PARAMS);
+		manager->setSetting(Ogre::InstanceManager::CAST_SHADOWS, bCastShadows, instancedMaterial);
+		mManagers[key] = manager;
+	}
+
+	// Custom parameters start from zero like the entity ones
+	Ogre::InstancedEntity* instance = mScene->createInstancedEntity(instancedMaterial, key);
+	for (int i = 0; i < INSTANCE_CUSTOM_PARAMS; i++)
+	{
+		instance->setCustomParam(i, Vector4::ZERO);
+	}
+	mInstanceCount++;
+	return instance;
+}
+
+
+void InstanceCache::destroy(Ogre::InstancedEntity* instance)
+{
+	if (instance)
+	{
+		mScene->destroyInstancedEntity(instance);
+		mInstanceCount--;
+	}
+}
+
+
+/*----------------------------------------------
+	Getters
+----------------------------------------------*/
+
+size_t InstanceCache::getInstanceCount()
+{
+	return mInstanceCount;
+}
+
+
+size_t InstanceCache::getManagerCount()
+{
+	return mManagers.size();
+}
+
+
+/*----------------------------------------------
+	Meshes & materials
+----------------------------------------------*/
+
+bool InstanceCache::isInstanceable(String file)
+{
+	Ogre::map<String, bool>::type::iterator it = mMeshes.find(file);
+	if (it != mMeshes.end())
+	{
+		return it->second;
+	}
+
+	// A manager draws one submesh : keep multi-material and skinned meshes as entities
+	Ogre::MeshPtr mesh = Ogre::MeshManager::getSingleton().getByName(file);
+	bool bInstanceable = !mesh.isNull() && mesh->getNumSubMeshes() == 1 && !mesh->hasSkeleton();
+
+	// The instance buffer starts at uv1, so only one UV set is supported
+	if (bInstanceable)
+	{
+		Ogre::SubMesh* submesh = mesh->getSubMesh(0);
+		Ogre::VertexData* data = submesh->useSharedVertices ? mesh->sharedVertexData : submesh->vertexData;
+		bInstanceable = (data->vertexDeclaration->findElementBySemantic(Ogre::VES_TEXTURE_COORDINATES, 1) == NULL);
+	}
+
+	mMeshes[file] = bInstanceable;
+	return bInstanceable;
+}
+
+
+String InstanceCache::getInstancedMaterial(String material)
+{
+	Ogre::map<String, String>::type::iterator it = mMaterials.find(material);
+	if (it != mMaterials.end())
+	{
+		return it->second;
+	}
+
+	// Source material
+	Ogre::MaterialPtr source = Ogre::MaterialManager::getSingleton().getByName(material);
+	if (source.isNull())
+	{
+		mMaterials[material] = "";
+		return "";
+	}
+	source->load();
+	String name = material + INSTANCED_SUFFIX;
+	Ogre::MaterialPtr clone = source->clone(name);
+
+	// Program replacement on every pass
+	Ogre::Material::TechniqueIterator techniques = clone->getTechniqueIterator();
+	while (techniques.hasMoreElements())
+	{
+		Ogre::Technique* technique = techniques.getNext();
+		Ogre::Technique::PassIterator passes = technique->getPassIterator();
+		while (passes.hasMoreElements())
+		{
+			Ogre::Pass* pass = passes.getNext();
+
+			// Vertex programs only use auto parameters, which are reset to the variant defaults
+			Ogre::map<String, String>::type::iterator vp = mVertexPrograms.find(pass->getVertexProgramName());
+			if (vp == mVertexPrograms.end())
+			{
+				Ogre::LogManager::getSingleton().logMessage("InstanceCache : no instanced program for " + material);
+				Ogre::MaterialManager::getSingleton().remove(name);
+				mMaterials[material] = "";
+				return "";
+			}
+			pass->setVertexProgram(vp->second);
+
+			// Fragment programs keep their material parameters
+			Ogre::map<String, String>::type::iterator fp = mFragmentPrograms.find(pass->getFragmentProgramName());
+			if (pass->hasFragmentProgram() && fp != mFragmentPrograms.end())
+			{
+				Ogre::GpuProgramParametersSharedPtr params = pass->getFragmentProgramParameters();
+				pass->setFragmentProgram(fp->second);
+				pass->getFragmentProgramParameters()->copyMatchingNamedConstantsFrom(*params.get());
+			}
+		}
+		technique->setShadowCasterMaterial(INSTANCED_SHADOW_CASTER);
+	}
+
+	clone->load();
+	mMaterials[material] = name;
+	return name;
+}
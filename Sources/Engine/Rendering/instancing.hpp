@@ -0,0 +1,105 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#ifndef __INSTANCING_H_
+#define __INSTANCING_H_
+
+#include "Engine/Rendering/renderer.hpp"
+#include "Engine/gametypes.hpp"
+
+#define INSTANCE_CUSTOM_PARAMS		4
+
+
+/*----------------------------------------------
+	Hardware instancing cache
+----------------------------------------------*/
+
+/**
+ * Meshes drawn with the same material share one instance manager, whose batches
+ * are rendered in a single draw call each. Instanced materials are built once as
+ * clones of the source material, with the vertex programs replaced by variants
+ * that read the world matrix and the custom parameters from the instance buffer.
+ **/
+class InstanceCache
+{
+
+public:
+
+	/**
+	 * @brief Create the cache
+	 * @param sm				Scene manager
+	 * @param s					System config
+	 **/
+	InstanceCache(Ogre::SceneManager* sm, tinyxml2::XMLElement* s);
+
+	/**
+	 * @brief Destroy all instance managers
+	 **/
+	~InstanceCache();
+
+	/**
+	 * @brief Create an instance of a mesh
+	 * @param file				Mesh file, already loaded
+	 * @param material			Material name
+	 * @param bCastShadows		Should cast shadows
+	 * @return the instance, or NULL when the mesh or material can't be instanced
+	 **/
+	Ogre::InstancedEntity* create(String file, String material, bool bCastShadows);
+
+	/**
+	 * @brief Destroy an instance, which must be detached
+	 * @param instance			Instance to destroy
+	 **/
+	void destroy(Ogre::InstancedEntity* instance);
+
+	/**
+	 * @brief Get the number of live instances
+	 * @return the instance count
+	 **/
+	size_t getInstanceCount();
+
+	/**
+	 * @brief Get the number of instance managers, one per mesh and material
+	 * @return the manager count
+	 **/
+	size_t getManagerCount();
+
+
+protected:
+
+	/**
+	 * @brief Check that a mesh fits the instanced vertex programs
+	 * @param file				Mesh file
+	 * @return true if the mesh can be instanced
+	 **/
+	bool isInstanceable(String file);
+
+	/**
+	 * @brief Get or build the instanced variant of a material
+	 * @param material			Source material name
+	 * @return the instanced material name, or "" if a program has no instanced variant
+	 **/
+	String getInstancedMaterial(String material);
+
+	// Settings
+	bool bEnabled;
+	int mBatchSize;
+	size_t mInstanceCount;
+	Ogre::SceneManager* mScene;
+
+	// Managers by mesh, material and shadows, instanced materials by source name
+	Ogre::map<String, Ogre::InstanceManager*>::type mManagers;
+	Ogre::map<String, String>::type mMaterials;
+	Ogre::map<String, bool>::type mMeshes;
+
+	// Instanced variants of the vertex and fragment programs
+	Ogre::map<String, String>::type mVertexPrograms;
+	Ogre::map<String, String>::type mFragmentPrograms;
+
+};
+
+#endif /* __INSTANCING_H_ */
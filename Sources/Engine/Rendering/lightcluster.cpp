@@ -0,0 +1,568 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#include "Engine/Rendering/lightcluster.hpp"
+#include "Engine/Rendering/deferredlight.hpp"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define LIGHT_CLUSTER_SSE
+#include <xmmintrin.h>
+#endif
+
+#define BENCH_WIDTH			1920
+#define BENCH_HEIGHT		1080
+#define BENCH_TILE_SIZE		64
+#define BENCH_SLICES		24
+#define BENCH_MAX_INDICES	(1 << 22)
+#define BENCH_FOV			60.0f
+#define BENCH_NEAR			1.0f
+#define BENCH_FAR			100000.0f
+#define BENCH_MIN_DEPTH		10.0f
+#define BENCH_MAX_DEPTH		5000.0f
+#define BENCH_MIN_RADIUS	10.0f
+#define BENCH_MAX_RADIUS	200.0f
+#define BENCH_ITERATIONS	100
+
+
+/*----------------------------------------------
+	Constructor
+----------------------------------------------*/
+
+LightCluster::LightCluster(int tileSize, int slices, int maxIndices)
+	: mTileSize(tileSize), mSlices(slices), mMaxIndices(maxIndices)
+{
+	mTilesX = 0;
+	mTilesY = 0;
+	mNearClip = 0;
+	mSliceScale = 0;
+	mIndexCount = 0;
+	mIndices.resize(mMaxIndices);
+	bVectorized = true;
+}
+
+
+/*----------------------------------------------
+	Frustum
+----------------------------------------------*/
+
+void LightCluster::setFrustum(int width, int height, const Ogre::Matrix4& proj, Real nearClip, Real farClip)
+{
+	mTilesX = (width + mTileSize - 1) / mTileSize;
+	mTilesY = (height + mTileSize - 1) / mTileSize;
+	mNearClip = nearClip;
+	mSliceScale = mSlices / Math::Log(farClip / nearClip);
+
+	// Planes are stored as three arrays padded to four : distance = a * center + z * depth + offset
+	int columns = (mTilesX + 4) & ~3;
+	int rows = (mTilesY + 4) & ~3;
+	int slices = (mSlices + 4) & ~3;
+	mColumnPlanes.assign(3 * columns, 0);
+	mRowPlanes.assign(3 * rows, 0);
+	mSlicePlanes.assign(3 * slices, 0);
+
+	// Tile edges go through the camera, positive on the side of the higher tiles
+	for (int i = 0; i <= mTilesX; i++)
+	{
+		Real ndc = -1 + 2.0f * i * mTileSize / width;
+		Real k = ndc + proj[0][2];
+		Real length = Math::Sqrt(proj[0][0] * proj[0][0] + k * k);
+		mColumnPlanes[i] = proj[0][0] / length;
+		mColumnPlanes[columns + i] = k / length;
+	}
+	for (int i = 0; i <= mTilesY; i++)
+	{
+		Real ndc = -1 + 2.0f * i * mTileSize / height;
+		Real k = ndc + proj[1][2];
+		Real length = Math::Sqrt(proj[1][1] * proj[1][1] + k * k);
+		mRowPlanes[i] = proj[1][1] / length;
+		mRowPlanes[rows + i] = k / length;
+	}
+
+	// Slice edges are at exponential depths, positive behind
+	for (int i = 0; i <= mSlices; i++)
+	{
+		mSlicePlanes[slices + i] = -1;
+		mSlicePlanes[2 * slices + i] = -nearClip * Math::Exp(i / mSliceScale);
+	}
+
+	// Clusters
+	mCounts.resize(mTilesX * mTilesY * mSlices);
+	mOffsets.resize(mCounts.size());
+	mCursors.resize(mCounts.size());
+}
+
+
+/*----------------------------------------------
+	Lights
+----------------------------------------------*/
+
+Real LightCluster::getLightRadius(Ogre::Light* light)
+{
+	return std::min(light->getAttenuationRange(), DeferredLight::getAttenuationRadius(light));
+}
+
+
+void LightCluster::clear()
+{
+	mLightX.clear();
+	mLightY.clear();
+	mLightZ.clear();
+	mLightRadius.clear();
+}
+
+
+void LightCluster::addLight(const Vector3& viewPos, Real radius)
+{
+	mLightX.push_back(viewPos.x);
+	mLightY.push_back(viewPos.y);
+	mLightZ.push_back(viewPos.z);
+	mLightRadius.push_back(radius);
+}
+
+
+void LightCluster::addLight(Ogre::Light* light, const Ogre::Matrix4& view)
+{
+	addLight(view * light->getDerivedPosition(), getLightRadius(light));
+}
+
+
+/*----------------------------------------------
+	Binning
+----------------------------------------------*/
+
+void LightCluster::build()
+{
+	size_t lightCount = mLightX.size();
+	mLightRanges.resize(lightCount * 6);
+	std::fill(mCounts.begin(), mCounts.end(), 0);
+
+	// Cluster ranges
+	for (size_t i = 0; i < lightCount; i++)
+	{
+		float x = mLightX[i];
+		float y = mLightY[i];
+		float z = mLightZ[i];
+		float radius = mLightRadius[i];
+		int* range = &mLightRanges[i * 6];
+		range[0] = 0;
+		range[1] = -1;
+		range[2] = 0;
+		range[3] = -1;
+
+		// Depth first, most lights out of the frustum stop there
+		findCells(mSlicePlanes, mSlices + 1, 0, z, radius, range[4], range[5]);
+		if (range[5] < range[4])
+		{
+			continue;
+		}
+
+		// A light around the camera touches every tile
+		if (DeferredLight::isCameraInsideSphere(Vector3::ZERO, Vector3(x, y, z), radius, mNearClip))
+		{
+			range[1] = mTilesX - 1;
+			range[3] = mTilesY - 1;
+		}
+		else
+		{
+			findCells(mColumnPlanes, mTilesX + 1, x, z, radius, range[0], range[1]);
+			findCells(mRowPlanes, mTilesY + 1, y, z, radius, range[2], range[3]);
+		}
+
+		for (int s = range[4]; s <= range[5]; s++)
+		{
+			for (int row = range[2]; row <= range[3]; row++)
+			{
+				int* counts = &mCounts[(s * mTilesY + row) * mTilesX];
+				for (int column = range[0]; column <= range[1]; column++)
+				{
+					counts[column]++;
+				}
+			}
+		}
+	}
+
+	// Index list offsets, clusters past the capacity are truncated
+	int offset = 0;
+	for (size_t c = 0; c < mCounts.size(); c++)
+	{
+		mOffsets[c] = offset;
+		mCounts[c] = std::min(mCounts[c], mMaxIndices - offset);
+		offset += mCounts[c];
+	}
+	mIndexCount = offset;
+
+	// Index lists
+	std::fill(mCursors.begin(), mCursors.end(), 0);
+	for (size_t i = 0; i < lightCount; i++)
+	{
+		const int* range = &mLightRanges[i * 6];
+		for (int s = range[4]; s <= range[5]; s++)
+		{
+			for (int row = range[2]; row <= range[3]; row++)
+			{
+				int first = (s * mTilesY + row) * mTilesX;
+				for (int c = first + range[0]; c <= first + range[1]; c++)
+				{
+					if (mCursors[c] < mCounts[c])
+					{
+						mIndices[mOffsets[c] + mCursors[c]] = (int)i;
+						mCursors[c]++;
+					}
+				}
+			}
+		}
+	}
+}
+
+
+void LightCluster::findCells(const Ogre::vector<float>::type& planes, int count, float a, float z, float radius, int& first, int& last)
+{
+	size_t stride = planes.size() / 3;
+	const float* planeA = &planes[0];
+	const float* planeZ = planeA + stride;
+	const float* planeOffset = planeZ + stride;
+
+	// First boundary the sphere reaches below, last one it reaches above
+	int below = count;
+	int above = -1;
+
+#ifdef LIGHT_CLUSTER_SSE
+	if (bVectorized)
+	{
+		static const int sLowestBit[16] = {4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0};
+		static const int sHighestBit[16] = {-1, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3};
+		__m128 centerA = _mm_set1_ps(a);
+		__m128 centerZ = _mm_set1_ps(z);
+		__m128 positive = _mm_set1_ps(radius);
+		__m128 negative = _mm_set1_ps(-radius);
+		for (int i = 0; i < count; i += 4)
+		{
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(planeA + i), centerA), _mm_mul_ps(_mm_loadu_ps(planeZ + i), centerZ)),
+				_mm_loadu_ps(planeOffset + i));
+			int valid = (count - i >= 4) ? 0xF : (1 << (count - i)) - 1;
+			int reachesBelow = _mm_movemask_ps(_mm_cmplt_ps(distance, positive)) & valid;
+			int reachesAbove = _mm_movemask_ps(_mm_cmpgt_ps(distance, negative)) & valid;
+			if (reachesBelow && below == count)
+			{
+				below = i + sLowestBit[reachesBelow];
+			}
+			if (reachesAbove)
+			{
+				above = i + sHighestBit[reachesAbove];
+			}
+		}
+	}
+	else
+#endif
+	{
+		for (int i = 0; i < count; i++)
+		{
+			float distance = planeA[i] * a + planeZ[i] * z + planeOffset[i];
+			if (distance < radius && below == count)
+			{
+				below = i;
+			}
+			if (distance > -radius)
+			{
+				above = i;
+			}
+		}
+	}
+
+	// A cell needs its lower boundary reached from above and its upper one from below
+	if (below == count || above < 0)
+	{
+		first = 0;
+		last = -1;
+	}
+	else
+	{
+		first = std::max(0, below - 1);
+		last = std::min(count - 2, above);
+	}
+}
+
+
+void LightCluster::setVectorized(bool bEnabled)
+{
+	bVectorized = bEnabled;
+}
+
+
+/*----------------------------------------------
+	Getters
+----------------------------------------------*/
+
+size_t LightCluster::getLightCount()
+{
+	return mLightX.size();
+}
+
+
+int LightCluster::getTilesX()
+{
+	return mTilesX;
+}
+
+
+int LightCluster::getTilesY()
+{
+	return mTilesY;
+}
+
+
+int LightCluster::getSlices()
+{
+	return mSlices;
+}
+
+
+Real LightCluster::getSliceScale()
+{
+	return mSliceScale;
+}
+
+
+int LightCluster::getIndexCount()
+{
+	return mIndexCount;
+}
+
+
+const int* LightCluster::getOffsets()
+{
+	return &mOffsets[0];
+}
+
+
+const int* LightCluster::getCounts()
+{
+	return &mCounts[0];
+}
+
+
+const int* LightCluster::getIndices()
+{
+	return &mIndices[0];
+}
+
+
+/*----------------------------------------------
+	Benchmark
+----------------------------------------------*/
+
+/**
+ * @brief Bin lights by testing every cluster, with boundary planes built again from the projection
+ * @param cluster		Cluster grid, for its size only
+ * @param proj			Projection matrix
+ * @param lights		View-space lights : position and radius
+ * @param lists			Light indices of every cluster to write
+ **/
+static void referenceBinning(LightCluster& cluster, const Ogre::Matrix4& proj, const Ogre::vector<Vector4>::type& lights,
+	Ogre::vector<Ogre::vector<int>::type>::type& lists)
+{
+	int tilesX = cluster.getTilesX();
+	int tilesY = cluster.getTilesY();
+	int slices = cluster.getSlices();
+	lists.assign(tilesX * tilesY * slices, Ogre::vector<int>::type());
+
+	// Boundary planes through the camera, and slice depths
+	Ogre::vector<float>::type columnA(tilesX + 1), columnZ(tilesX + 1);
+	Ogre::vector<float>::type rowA(tilesY + 1), rowZ(tilesY + 1);
+	Ogre::vector<float>::type sliceDepth(slices + 1);
+	for (int i = 0; i <= tilesX; i++)
+	{
+		Real k = -1 + 2.0f * i * BENCH_TILE_SIZE / BENCH_WIDTH + proj[0][2];
+		Real length = Math::Sqrt(proj[0][0] * proj[0][0] + k * k);
+		columnA[i] = proj[0][0] / length;
+		columnZ[i] = k / length;
+	}
+	for (int i = 0; i <= tilesY; i++)
+	{
+		Real k = -1 + 2.0f * i * BENCH_TILE_SIZE / BENCH_HEIGHT + proj[1][2];
+		Real length = Math::Sqrt(proj[1][1] * proj[1][1] + k * k);
+		rowA[i] = proj[1][1] / length;
+		rowZ[i] = k / length;
+	}
+	for (int i = 0; i <= slices; i++)
+	{
+		sliceDepth[i] = BENCH_NEAR * Math::Exp(i / cluster.getSliceScale());
+	}
+
+	// A cluster holds a light when the sphere reaches inside all of its six boundaries
+	Ogre::vector<float>::type columnDistance(tilesX + 1), rowDistance(tilesY + 1), sliceDistance(slices + 1);
+	for (size_t i = 0; i < lights.size(); i++)
+	{
+		float x = lights[i].x;
+		float y = lights[i].y;
+		float z = lights[i].z;
+		float radius = lights[i].w;
+		bool bInside = DeferredLight::isCameraInsideSphere(Vector3::ZERO, Vector3(x, y, z), radius, BENCH_NEAR);
+		for (int j = 0; j <= tilesX; j++)
+		{
+			columnDistance[j] = columnA[j] * x + columnZ[j] * z;
+		}
+		for (int j = 0; j <= tilesY; j++)
+		{
+			rowDistance[j] = rowA[j] * y + rowZ[j] * z;
+		}
+		for (int j = 0; j <= slices; j++)
+		{
+			sliceDistance[j] = -z - sliceDepth[j];
+		}
+
+		for (int s = 0; s < slices; s++)
+		{
+			for (int row = 0; row < tilesY; row++)
+			{
+				for (int column = 0; column < tilesX; column++)
+				{
+					bool bTouched = (sliceDistance[s] > -radius && sliceDistance[s + 1] < radius)
+						&& (bInside || (columnDistance[column] > -radius && columnDistance[column + 1] < radius
+							&& rowDistance[row] > -radius && rowDistance[row + 1] < radius));
+					if (bTouched)
+					{
+						lists[(s * tilesY + row) * tilesX + column].push_back((int)i);
+					}
+				}
+			}
+		}
+	}
+}
+
+
+/**
+ * @brief Compare the cluster lists with the reference
+ * @param cluster		Built cluster grid
+ * @param lists			Reference light indices of every cluster
+ * @return the number of clusters that differ
+ **/
+static int compareBinning(LightCluster& cluster, const Ogre::vector<Ogre::vector<int>::type>::type& lists)
+{
+	int mismatches = 0;
+	for (size_t c = 0; c < lists.size(); c++)
+	{
+		const int* indices = cluster.getIndices() + cluster.getOffsets()[c];
+		int count = cluster.getCounts()[c];
+		if (count != (int)lists[c].size() || (count > 0 && memcmp(indices, &lists[c][0], count * sizeof(int)) != 0))
+		{
+			mismatches++;
+		}
+	}
+	return mismatches;
+}
+
+
+int benchmarkLightCluster(int lightCount)
+{
+	// Only the log is needed
+	Ogre::Root* root = new Ogre::Root("", "", "LightBench.log");
+	Ogre::Log* log = Ogre::LogManager::getSingleton().getDefaultLog();
+
+	// Projection matrix as built by the camera, without render target flipping
+	Real aspect = (Real)BENCH_WIDTH / BENCH_HEIGHT;
+	Real tanFov = Math::Tan(Degree(BENCH_FOV / 2));
+	Ogre::Matrix4 proj = Ogre::Matrix4::ZERO;
+	proj[0][0] = 1 / (aspect * tanFov);
+	proj[1][1] = 1 / tanFov;
+	proj[2][2] = -(BENCH_FAR + BENCH_NEAR) / (BENCH_FAR - BENCH_NEAR);
+	proj[2][3] = -2 * BENCH_FAR * BENCH_NEAR / (BENCH_FAR - BENCH_NEAR);
+	proj[3][2] = -1;
+	LightCluster cluster(BENCH_TILE_SIZE, BENCH_SLICES, BENCH_MAX_INDICES);
+	cluster.setFrustum(BENCH_WIDTH, BENCH_HEIGHT, proj, BENCH_NEAR, BENCH_FAR);
+
+	// Lights around the view frustum, denser near the camera, the same on every run
+	srand(0);
+	Ogre::vector<Vector4>::type lights(lightCount);
+	for (int i = 0; i < lightCount; i++)
+	{
+		Real depth = Math::Exp(Math::RangeRandom(Math::Log(BENCH_MIN_DEPTH), Math::Log(BENCH_MAX_DEPTH)));
+		Real x = Math::RangeRandom(-1.2f, 1.2f) * depth * aspect * tanFov;
+		Real y = Math::RangeRandom(-1.2f, 1.2f) * depth * tanFov;
+		lights[i] = Vector4(x, y, -depth, Math::RangeRandom(BENCH_MIN_RADIUS, BENCH_MAX_RADIUS));
+	}
+
+	// Frame timings, including the light upload
+	Ogre::Timer timer;
+	unsigned long total = 0;
+	unsigned long best = 0;
+	unsigned long worst = 0;
+	for (int i = 0; i < BENCH_ITERATIONS; i++)
+	{
+		timer.reset();
+		cluster.clear();
+		for (int j = 0; j < lightCount; j++)
+		{
+			cluster.addLight(Vector3(lights[j].x, lights[j].y, lights[j].z), lights[j].w);
+		}
+		cluster.build();
+		unsigned long time = timer.getMicroseconds();
+
+		total += time;
+		best = (i == 0) ? time : std::min(best, time);
+		worst = std::max(worst, time);
+	}
+
+	// Cluster occupancy
+	int clusterCount = cluster.getTilesX() * cluster.getTilesY() * cluster.getSlices();
+	int litClusters = 0;
+	int maxLights = 0;
+	for (int c = 0; c < clusterCount; c++)
+	{
+		litClusters += (cluster.getCounts()[c] > 0) ? 1 : 0;
+		maxLights = std::max(maxLights, cluster.getCounts()[c]);
+	}
+
+	// Report
+	log->logMessage("benchmarkLightCluster : " + StringConverter::toString(lightCount) + " lights, "
+		+ StringConverter::toString(cluster.getTilesX()) + "x" + StringConverter::toString(cluster.getTilesY())
+		+ "x" + StringConverter::toString(cluster.getSlices()) + " clusters");
+	log->logMessage("benchmarkLightCluster : average " + StringConverter::toString(total / 1000.0f / BENCH_ITERATIONS)
+		+ " ms, best " + StringConverter::toString(best / 1000.0f)
+		+ " ms, worst " + StringConverter::toString(worst / 1000.0f) + " ms");
+	log->logMessage("benchmarkLightCluster : " + StringConverter::toString(cluster.getIndexCount()) + " indices"
+		+ (cluster.getIndexCount() == BENCH_MAX_INDICES ? " (truncated), " : ", ")
+		+ StringConverter::toString(litClusters) + " lit clusters, up to "
+		+ StringConverter::toString(maxLights) + " lights per cluster");
+
+	// Every binning path against the brute-force reference, same lights in the same order, on a grid large enough for all of them
+	Ogre::vector<Ogre::vector<int>::type>::type reference;
+	referenceBinning(cluster, proj, lights, reference);
+	int indexCount = 0;
+	for (size_t c = 0; c < reference.size(); c++)
+	{
+		indexCount += (int)reference[c].size();
+	}
+	LightCluster check(BENCH_TILE_SIZE, BENCH_SLICES, std::max(indexCount, 1));
+	check.setFrustum(BENCH_WIDTH, BENCH_HEIGHT, proj, BENCH_NEAR, BENCH_FAR);
+	int failures = 0;
+#ifdef LIGHT_CLUSTER_SSE
+	const int pathCount = 2;
+#else
+	const int pathCount = 1;
+#endif
+	for (int path = 0; path < pathCount; path++)
+	{
+		bool bScalar = (path == pathCount - 1);
+		check.setVectorized(!bScalar);
+		check.clear();
+		for (int j = 0; j < lightCount; j++)
+		{
+			check.addLight(Vector3(lights[j].x, lights[j].y, lights[j].z), lights[j].w);
+		}
+		check.build();
+
+		int mismatches = compareBinning(check, reference);
+		log->logMessage("benchmarkLightCluster : " + String(bScalar ? "scalar" : "SSE") + " binning "
+			+ (mismatches == 0 ? String("matches the reference") : StringConverter::toString(mismatches) + " clusters differ from the reference"));
+		failures += mismatches;
+	}
+
+	delete root;
+	return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#ifndef __LIGHT_CLUSTER_H_
+#define __LIGHT_CLUSTER_H_
+
+#include "Engine/Rendering/renderer.hpp"
+#include "Engine/gametypes.hpp"
+
+
+/*----------------------------------------------
+	Light binning
+----------------------------------------------*/
+
+/**
+ * CPU light binning into screen tiles and exponential depth slices, without any
+ * render system. Lights are view-space spheres, tested four tile or slice boundary
+ * planes at a time : a light gets the cluster ranges its sphere can touch, and every
+ * cluster gets the list of its light indices.
+ **/
+class LightCluster
+{
+
+public:
+
+	/**
+	 * @brief Create an empty cluster grid
+	 * @param tileSize		Tile size in pixels
+	 * @param slices		Depth slice count
+	 * @param maxIndices	Light index capacity over all clusters
+	 **/
+	LightCluster(int tileSize, int slices, int maxIndices);
+
+	/**
+	 * @brief Set the viewport and the camera frustum, rebuilds the boundary planes
+	 * @param width			Viewport width in pixels
+	 * @param height		Viewport height in pixels
+	 * @param proj			Projection matrix, without render target flipping
+	 * @param nearClip		Near clip distance
+	 * @param farClip		Far clip distance
+	 **/
+	void setFrustum(int width, int height, const Ogre::Matrix4& proj, Real nearClip, Real farClip);
+
+	/**
+	 * @brief Get the distance where a point light stops contributing
+	 * @param light			Scene light
+	 * @return the light range, or the attenuation radius if shorter
+	 **/
+	static Real getLightRadius(Ogre::Light* light);
+
+	/**
+	 * @brief Remove all lights, before a new frame
+	 **/
+	void clear();
+
+	/**
+	 * @brief Add a light sphere, its index is the light count before the call
+	 * @param viewPos		View-space position
+	 * @param radius		Light radius
+	 **/
+	void addLight(const Vector3& viewPos, Real radius);
+
+	/**
+	 * @brief Add a scene light
+	 * @param light			Scene light
+	 * @param view			Camera view matrix
+	 **/
+	void addLight(Ogre::Light* light, const Ogre::Matrix4& view);
+
+	/**
+	 * @brief Bin all lights, clusters past the index capacity are truncated
+	 **/
+	void build();
+
+	/**
+	 * @brief Choose the SSE or the scalar boundary tests, both give the same clusters
+	 * @param bEnabled		true for SSE, ignored where it is not available
+	 **/
+	void setVectorized(bool bEnabled);
+
+	/**
+	 * @brief Get the number of lights in this frame
+	 * @return the light count
+	 **/
+	size_t getLightCount();
+
+	/**
+	 * @brief Get the grid size
+	 * @return the tile count in X
+	 **/
+	int getTilesX();
+
+	/**
+	 * @brief Get the grid size
+	 * @return the tile count in Y
+	 **/
+	int getTilesY();
+
+	/**
+	 * @brief Get the grid size
+	 * @return the slice count
+	 **/
+	int getSlices();
+
+	/**
+	 * @brief Get the slice scale : slice = log(depth / near) * scale
+	 * @return the slice scale
+	 **/
+	Real getSliceScale();
+
+	/**
+	 * @brief Get the used light indices
+	 * @return the index count over all clusters
+	 **/
+	int getIndexCount();
+
+	/**
+	 * @brief Get the first index of each cluster, ordered by slice, row and column
+	 * @return the offset array
+	 **/
+	const int* getOffsets();
+
+	/**
+	 * @brief Get the light count of each cluster
+	 * @return the count array
+	 **/
+	const int* getCounts();
+
+	/**
+	 * @brief Get the light index lists
+	 * @return the index array
+	 **/
+	const int* getIndices();
+
+
+protected:
+
+	/**
+	 * @brief Find the cells a sphere can touch, from the distances to the cell boundaries
+	 * @param planes		Boundary planes as three arrays : a factor, z factor, offset
+	 * @param count			Boundary count, one more than the cell count
+	 * @param a				Sphere center coordinate along the axis
+	 * @param z				Sphere center view depth
+	 * @param radius		Sphere radius
+	 * @param first			First cell to write
+	 * @param last			Last cell to write, lower than first if none
+	 **/
+	void findCells(const Ogre::vector<float>::type& planes, int count, float a, float z, float radius, int& first, int& last);
+
+	// Settings
+	int mTileSize;
+	int mSlices;
+	int mMaxIndices;
+	bool bVectorized;
+
+	// Grid and boundary planes for the current frustum
+	int mTilesX;
+	int mTilesY;
+	Real mNearClip;
+	Real mSliceScale;
+	Ogre::vector<float>::type mColumnPlanes;
+	Ogre::vector<float>::type mRowPlanes;
+	Ogre::vector<float>::type mSlicePlanes;
+
+	// Lights
+	Ogre::vector<float>::type mLightX;
+	Ogre::vector<float>::type mLightY;
+	Ogre::vector<float>::type mLightZ;
+	Ogre::vector<float>::type mLightRadius;
+	Ogre::vector<int>::type mLightRanges;
+
+	// Clusters
+	Ogre::vector<int>::type mCounts;
+	Ogre::vector<int>::type mOffsets;
+	Ogre::vector<int>::type mCursors;
+	Ogre::vector<int>::type mIndices;
+	int mIndexCount;
+
+};
+
+
+/*----------------------------------------------
+	Benchmark
+----------------------------------------------*/
+
+/**
+ * @brief Time the binning of random lights on a 1080p grid, without any render system,
+ * then check the SSE and scalar binning against a brute-force test of every cluster
+ * @param lightCount	Light count
+ * @return zero if all the cluster lists match, one otherwise
+ **/
+int benchmarkLightCluster(int lightCount);
+
+#endif /* __LIGHT_CLUSTER_H_ */
@@ -62,8 +62,8 @@ const Ogre::MaterialPtr& LightMaterialGenerator::getMaterial(Perm permutation)
 		else
 		{
 			Ogre::String programName = (permutation & vsMask & LightMaterialGenerator::MI_DIRECTIONAL) ? "VS_Ambient" : "VS_LightMaterial";
-			mVs[permutation] = Ogre::HighLevelGpuProgramManager::getSingleton().getByName(programName);
-			vs = mVs[permutation];
+			vs = Ogre::HighLevelGpuProgramManager::getSingleton().getByName(programName);
+			mVs[permutation & vsMask] = vs;
 		}
 		assert (!vs.isNull());
 
@@ -76,21 +76,26 @@ const Ogre::MaterialPtr& LightMaterialGenerator::getMaterial(Perm permutation)
 		}
 		else
 		{
-			mFs[permutation] = generateFragmentShader(permutation & fsMask);
-			fs = mFs[permutation];
+			fs = generateFragmentShader(permutation & fsMask);
+			mFs[permutation & fsMask] = fs;
 		}
 		assert (!fs.isNull());
 		
 		// Create material name
 		Ogre::String name = mBaseName + Ogre::StringConverter::toString(permutation);
-		std::cerr << name << " " << vs->getName() << " " << fs->getName() << std::endl;
-
-		// Create material from template, and set shaders
-		Ogre::MaterialPtr mat = templ->clone(name);
-		Ogre::Technique *tech = mat->getTechnique(0);
-		Ogre::Pass *pass = tech->getPass(0);
-		pass->setFragmentProgram(fs->getName());
-		pass->setVertexProgram(vs->getName());
+		Ogre::LogManager::getSingleton().logMessage("LightMaterialGenerator : " + name + " "
+			+ vs->getName() + " " + fs->getName(), Ogre::LML_TRIVIAL);
+
+		// Create material from template, and set shaders, another generator may already have done it
+		Ogre::MaterialPtr mat = Ogre::MaterialManager::getSingleton().getByName(name);
+		if (mat.isNull())
+		{
+			mat = templ->clone(name);
+			Ogre::Technique *tech = mat->getTechnique(0);
+			Ogre::Pass *pass = tech->getPass(0);
+			pass->setFragmentProgram(fs->getName());
+			pass->setVertexProgram(vs->getName());
+		}
 	
 		// And store it
 		mMaterials[permutation] = mat;
@@ -99,6 +104,53 @@ const Ogre::MaterialPtr& LightMaterialGenerator::getMaterial(Perm permutation)
 }
 
 
+void LightMaterialGenerator::warmUp()
+{
+	Ogre::Timer timer;
+	const Perm types[3] = {MI_POINT, MI_SPOTLIGHT, MI_DIRECTIONAL};
+	const Perm options[3] = {MI_SPECULAR, MI_ATTENUATED, MI_SHADOW_CASTER};
+
+	// Every light type with every option combination
+	Ogre::RenderSystem* rs = Ogre::Root::getSingleton().getRenderSystem();
+	int count = 0;
+	for (int type = 0; type < 3; type++)
+	{
+		for (int mask = 0; mask < 8; mask++)
+		{
+			Perm permutation = types[type];
+			for (int option = 0; option < 3; option++)
+			{
+				if (mask & (1 << option))
+				{
+					permutation |= options[option];
+				}
+			}
+			const Ogre::MaterialPtr& mat = getMaterial(permutation);
+			mat->load();
+			count++;
+
+			// Loading only compiles the shaders : binding them with their parameters links them now, not at the first draw
+			Ogre::Technique* tech = mat->getBestTechnique();
+			for (unsigned short i = 0; i < tech->getNumPasses(); i++)
+			{
+				Ogre::Pass* pass = tech->getPass(i);
+				if (pass->hasVertexProgram() && pass->hasFragmentProgram())
+				{
+					rs->bindGpuProgram(pass->getVertexProgram()->_getBindingDelegate());
+					rs->bindGpuProgram(pass->getFragmentProgram()->_getBindingDelegate());
+					rs->bindGpuProgramParameters(Ogre::GPT_FRAGMENT_PROGRAM, pass->getFragmentProgramParameters(), Ogre::GPV_ALL);
+					rs->unbindGpuProgram(Ogre::GPT_FRAGMENT_PROGRAM);
+					rs->unbindGpuProgram(Ogre::GPT_VERTEX_PROGRAM);
+				}
+			}
+		}
+	}
+
+	Ogre::LogManager::getSingleton().logMessage("LightMaterialGenerator : " + Ogre::StringConverter::toString(count)
+		+ " permutations loaded and linked in " + Ogre::StringConverter::toString(timer.getMilliseconds()) + "ms");
+}
+
+
 Ogre::GpuProgramPtr LightMaterialGenerator::generateFragmentShader(Perm permutation)
 {
     int numSamplers = 0;
@@ -115,9 +167,14 @@ Ogre::GpuProgramPtr LightMaterialGenerator::generateFragmentShader(Perm permutat
 	}
 	assert (mMasterSource.empty()==false);
 
-	// Create new shader
+	// Create new shader, or reuse the one of another generator
 	Ogre::String name = mBaseName+ "PS_" + Ogre::StringConverter::toString(permutation)+"_ps";
-	Ogre::HighLevelGpuProgramPtr ptrProgram = Ogre::HighLevelGpuProgramManager::getSingleton().createProgram(
+	Ogre::HighLevelGpuProgramPtr ptrProgram = Ogre::HighLevelGpuProgramManager::getSingleton().getByName(name);
+	if (!ptrProgram.isNull())
+	{
+		return Ogre::GpuProgramPtr(ptrProgram);
+	}
+	ptrProgram = Ogre::HighLevelGpuProgramManager::getSingleton().createProgram(
 		name,
 		Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
 		"glsl", Ogre::GPT_FRAGMENT_PROGRAM);
@@ -202,8 +259,7 @@ void LightMaterialGenerator::setUpBaseParameters(const Ogre::GpuProgramParameter
 		{ "lightPos",           Ogre::GpuProgramParameters::ACT_LIGHT_POSITION_VIEW_SPACE },
 		{ "lightDir",           Ogre::GpuProgramParameters::ACT_LIGHT_DIRECTION_VIEW_SPACE },
 		{ "spotParams",         Ogre::GpuProgramParameters::ACT_SPOTLIGHT_PARAMS },
-		{ "farClipDistance",    Ogre::GpuProgramParameters::ACT_FAR_CLIP_DISTANCE },
-		{ "shadowViewProjMat",  Ogre::GpuProgramParameters::ACT_TEXTURE_VIEWPROJ_MATRIX }
+		{ "farClipDistance",    Ogre::GpuProgramParameters::ACT_FAR_CLIP_DISTANCE }
 	};
 	int numParams = sizeof(AUTO_PARAMS) / sizeof(AutoParamPair);
     
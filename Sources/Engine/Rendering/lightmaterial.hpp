@@ -51,6 +51,11 @@ public:
 	 * @return a pointer to the material
 	 **/
 	const Ogre::MaterialPtr& getMaterial(Perm permutation);
+	
+	/**
+	 * @brief Create, load and link every light permutation, before the first frame
+	 **/
+	void warmUp();
 
 
 protected:
@@ -0,0 +1,139 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#include "Engine/Rendering/materialparams.hpp"
+
+
+/*----------------------------------------------
+	Constructor
+----------------------------------------------*/
+
+MaterialParamBuffer::MaterialParamBuffer()
+{
+	mUploadCount = 0;
+}
+
+
+/*----------------------------------------------
+	Blocks
+----------------------------------------------*/
+
+int MaterialParamBuffer::allocate()
+{
+	int block;
+	if (mFreeBlocks.size() > 0)
+	{
+		block = mFreeBlocks.back();
+		mFreeBlocks.pop_back();
+	}
+	else
+	{
+		block = (int)mTargets.size();
+		mTargets.push_back(Target());
+		mUsed.push_back(0);
+		mDirty.push_back(0);
+		mValues.resize(mValues.size() + MATERIAL_PARAM_COUNT);
+	}
+
+	// Parameters that were never written are left to the material defaults
+	for (int i = 0; i < MATERIAL_PARAM_COUNT; i++)
+	{
+		mValues[block * MATERIAL_PARAM_COUNT + i] = Vector4::ZERO;
+	}
+	mTargets[block].entity = NULL;
+	mTargets[block].instance = NULL;
+	mUsed[block] = 0;
+	mDirty[block] = 0;
+	return block;
+}
+
+
+void MaterialParamBuffer::release(int block)
+{
+	mTargets[block].entity = NULL;
+	mTargets[block].instance = NULL;
+	mDirty[block] = 0;
+	mFreeBlocks.push_back(block);
+}
+
+
+void MaterialParamBuffer::bind(int block, Ogre::Entity* entity, Ogre::InstancedEntity* instance)
+{
+	mTargets[block].entity = entity;
+	mTargets[block].instance = instance;
+	mDirty[block] = mUsed[block];
+}
+
+
+void MaterialParamBuffer::set(int block, int first, const Vector4* values, int count)
+{
+	Vector4* data = &mValues[block * MATERIAL_PARAM_COUNT];
+	unsigned char used = mUsed[block];
+	unsigned char dirty = mDirty[block];
+	for (int i = 0; i < count; i++)
+	{
+		int index = first + i;
+		if (data[index] != values[i] || (used & (1 << index)) == 0)
+		{
+			data[index] = values[i];
+			dirty |= (1 << index);
+		}
+		used |= (1 << index);
+	}
+	mUsed[block] = used;
+	mDirty[block] = dirty;
+}
+
+
+/*----------------------------------------------
+	Upload
+----------------------------------------------*/
+
+void MaterialParamBuffer::flush()
+{
+	mUploadCount = 0;
+	for (size_t block = 0; block < mTargets.size(); block++)
+	{
+		unsigned char dirty = mDirty[block];
+		if (dirty == 0)
+		{
+			continue;
+		}
+		mDirty[block] = 0;
+
+		// Changed values only
+		Target& target = mTargets[block];
+		const Vector4* data = &mValues[block * MATERIAL_PARAM_COUNT];
+		for (int i = 0; i < MATERIAL_PARAM_COUNT; i++)
+		{
+			if ((dirty & (1 << i)) == 0)
+			{
+				continue;
+			}
+			if (target.instance)
+			{
+				target.instance->setCustomParam(i, data[i]);
+				mUploadCount++;
+			}
+			else if (target.entity)
+			{
+				int numSubEnt = target.entity->getNumSubEntities();
+				for (int j = 0; j < numSubEnt; j++)
+				{
+					target.entity->getSubEntity(j)->setCustomParameter(i, data[i]);
+				}
+				mUploadCount++;
+			}
+		}
+	}
+}
+
+
+size_t MaterialParamBuffer::getUploadCount()
+{
+	return mUploadCount;
+}
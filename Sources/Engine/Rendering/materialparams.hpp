@@ -0,0 +1,97 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#ifndef __MATERIAL_PARAMS_H_
+#define __MATERIAL_PARAMS_H_
+
+#include "Engine/Rendering/instancing.hpp"
+#include "Engine/gametypes.hpp"
+
+#define MATERIAL_PARAM_COUNT		INSTANCE_CUSTOM_PARAMS
+
+
+/*----------------------------------------------
+	Material parameter buffer
+----------------------------------------------*/
+
+/**
+ * Custom material parameters of all meshes, stored as one contiguous block of
+ * MATERIAL_PARAM_COUNT values per mesh. Writes only mark the block as dirty, the
+ * changed values are sent to the entities and instances once per frame by flush.
+ * Writing to distinct blocks is safe from the parallel tick.
+ **/
+class MaterialParamBuffer
+{
+
+public:
+
+	/**
+	 * @brief Create an empty buffer
+	 **/
+	MaterialParamBuffer();
+
+	/**
+	 * @brief Reserve a parameter block, from the main thread only
+	 * @return the block index
+	 **/
+	int allocate();
+
+	/**
+	 * @brief Free a parameter block
+	 * @param block			Block index
+	 **/
+	void release(int block);
+
+	/**
+	 * @brief Set the mesh that receives a block, its written values are uploaded again
+	 * @param block			Block index
+	 * @param entity		Entity, or NULL
+	 * @param instance		Instanced entity, or NULL
+	 **/
+	void bind(int block, Ogre::Entity* entity, Ogre::InstancedEntity* instance);
+
+	/**
+	 * @brief Write consecutive parameters, unchanged values are skipped
+	 * @param block			Block index
+	 * @param first			First parameter index
+	 * @param values		Parameter values
+	 * @param count			Value count
+	 **/
+	void set(int block, int first, const Vector4* values, int count);
+
+	/**
+	 * @brief Upload the dirty blocks, before rendering
+	 **/
+	void flush();
+
+	/**
+	 * @brief Get the number of values uploaded by the last flush
+	 * @return the upload count
+	 **/
+	size_t getUploadCount();
+
+
+protected:
+
+	// Mesh that receives a block
+	struct Target
+	{
+		Ogre::Entity* entity;
+		Ogre::InstancedEntity* instance;
+	};
+
+	// Values, and masks per block with a bit per parameter : written once, and changed
+	Ogre::vector<Vector4>::type mValues;
+	Ogre::vector<unsigned char>::type mUsed;
+	Ogre::vector<unsigned char>::type mDirty;
+	Ogre::vector<Target>::type mTargets;
+	Ogre::vector<int>::type mFreeBlocks;
+	size_t mUploadCount;
+
+};
+
+#endif /* __MATERIAL_PARAMS_H_ */
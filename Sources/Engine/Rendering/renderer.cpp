@@ -24,6 +24,10 @@ Renderer::Renderer(Ogre::Viewport* vp, Ogre::SceneManager* sm, tinyxml2::XMLElem
 	int aniso = config->FirstChildElement("anisotropy")->IntAttribute("value");
 	size_t mipmaps = (size_t)(config->FirstChildElement("mipmaps")->IntAttribute("value"));
 	float distance = config->FirstChildElement("shadowDistance")->FloatAttribute("value");
+	mShaderCache = config->FirstChildElement("shaderCache")->Attribute("value");
+
+	// Compiled shaders, before any program is linked
+	loadShaderCache();
 
 	// Texture filtering
 	Ogre::TextureManager::getSingleton().setDefaultNumMipmaps(mipmaps);
@@ -42,7 +46,7 @@ Renderer::Renderer(Ogre::Viewport* vp, Ogre::SceneManager* sm, tinyxml2::XMLElem
 	
 	// GBuffer creation
 	Ogre::CompositorManager &compMan = Ogre::CompositorManager::getSingleton();
-	compMan.registerCustomCompositionPass("DeferredLight", new DeferredRenderPass);
+	compMan.registerCustomCompositionPass("DeferredLight", new DeferredRenderPass(s));
 	Ogre::CompositorInstance* gbuffer = compMan.addCompositor(mViewport, "DeferredShading/GBuffer");
 	gbuffer->setEnabled(true);
 	
@@ -74,6 +78,50 @@ Renderer::~Renderer()
 }
 
 
+/*----------------------------------------------
+	Shader cache
+----------------------------------------------*/
+
+void Renderer::loadShaderCache()
+{
+	Ogre::GpuProgramManager& programs = Ogre::GpuProgramManager::getSingleton();
+	if (mShaderCache == "" || !programs.canGetCompiledShaderBuffer())
+	{
+		Ogre::LogManager::getSingleton().logMessage("Renderer : shader cache disabled");
+		mShaderCache = "";
+		return;
+	}
+	programs.setSaveMicrocodesToCache(true);
+
+	// No file on the first launch
+	std::ifstream file(mShaderCache.c_str(), std::ios::in | std::ios::binary);
+	if (file.is_open())
+	{
+		Ogre::DataStreamPtr stream(OGRE_NEW Ogre::FileStreamDataSource(mShaderCache, &file, false));
+		programs.loadMicrocodeCache(stream);
+		Ogre::LogManager::getSingleton().logMessage("Renderer : shader cache loaded from " + mShaderCache);
+	}
+}
+
+
+void Renderer::saveShaderCache()
+{
+	Ogre::GpuProgramManager& programs = Ogre::GpuProgramManager::getSingleton();
+	if (mShaderCache == "" || !programs.isCacheDirty())
+	{
+		return;
+	}
+
+	std::fstream file(mShaderCache.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (file.is_open())
+	{
+		Ogre::DataStreamPtr stream(OGRE_NEW Ogre::FileStreamDataSource(mShaderCache, &file, false));
+		programs.saveMicrocodeCache(stream);
+		Ogre::LogManager::getSingleton().logMessage("Renderer : shader cache saved to " + mShaderCache);
+	}
+}
+
+
 /*----------------------------------------------
 	Compositor switch
 ----------------------------------------------*/
@@ -14,6 +14,7 @@
 #include "OgreConfigFile.h"
 #include "OgreStringConverter.h"
 #include "OgreSceneManager.h"
+#include "OgreDefaultHardwareBufferManager.h"
 #include <OgreWindowEventUtilities.h>
 
 #include <Overlay/OgreOverlaySystem.h>
@@ -59,15 +60,26 @@ public:
 	 * @param mode				New rendering mode
 	 **/
 	void setMode(DSMode mode);
+	
+	/**
+	 * @brief Write the compiled shaders to the cache file if new ones were built
+	 **/
+	void saveShaderCache();
 
 	
 protected:
 	
+	/**
+	 * @brief Read the compiled shaders of the previous launches
+	 **/
+	void loadShaderCache();
+	
 	// Scene data
 	DSMode mCurrentMode;
 	Ogre::Viewport* mViewport;
 	Ogre::SceneManager* mScene;
 	Ogre::CompositorInstance* mInstance[DSM_NONE];
+	Ogre::String mShaderCache;
 };
 
 
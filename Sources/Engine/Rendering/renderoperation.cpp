@@ -6,13 +6,15 @@
 **/
 
 #include "Engine/Rendering/renderoperation.hpp"
+#include "Engine/profiler.hpp"
 
 
 /*----------------------------------------------
 	Constructor & destructor
 ----------------------------------------------*/
 
-RenderOperation::RenderOperation(Ogre::CompositorInstance* instance, const Ogre::CompositionPass* pass)
+RenderOperation::RenderOperation(Ogre::CompositorInstance* instance, const Ogre::CompositionPass* pass, ClusteredLight* clustered, ShadowAtlas* shadows)
+	: mClusteredLight(clustered), mShadowAtlas(shadows)
 {
 	mViewport = instance->getChain()->getViewport();
 	
@@ -22,8 +24,9 @@ RenderOperation::RenderOperation(Ogre::CompositorInstance* instance, const Ogre:
 	const Ogre::CompositionPass::InputTex& input1 = pass->getInput(1);
 	mTexName1 = instance->getTextureInstanceName(input1.name, input1.mrtIndex);
 
-	// Create the lighting data
+	// Create the lighting data, all light permutations are compiled now rather than when a light first shows up
 	mLightMaterialGenerator = new LightMaterialGenerator();
+	mLightMaterialGenerator->warmUp();
 	mAmbientLight = new AmbientLight();
 	const Ogre::MaterialPtr& mat = mAmbientLight->getMaterial();
 	mat->load();
@@ -39,6 +42,11 @@ RenderOperation::~RenderOperation()
 	mLights.clear();
 	
 	delete mAmbientLight;
+	if (mClusteredLight)
+	{
+		delete mClusteredLight;
+	}
+	delete mShadowAtlas;
 	delete mLightMaterialGenerator;
 }
 
@@ -74,6 +82,7 @@ void injectTechnique(Ogre::SceneManager* sm, Ogre::Technique* tech, Ogre::Render
 
 void RenderOperation::execute(Ogre::SceneManager *sm, Ogre::RenderSystem *rs)
 {
+	ProfileZone zone("Lighting");
     Ogre::Camera* cam = mViewport->getCamera();
 
 	// Compute the ambient lighting
@@ -83,9 +92,22 @@ void RenderOperation::execute(Ogre::SceneManager *sm, Ogre::RenderSystem *rs)
 
 	// For each light, compute the lighting 
 	const Ogre::LightList& lightList = sm->_getLightsAffectingFrustum();
+	mShadowAtlas->beginFrame();
+	if (mClusteredLight)
+	{
+		mClusteredLight->clear();
+	}
     for (Ogre::LightList::const_iterator it = lightList.begin(); it != lightList.end(); it++) 
 	{
         Ogre::Light* light = *it;
+
+		// Point lights are shaded together after this loop
+		if (mClusteredLight && ClusteredLight::isClustered(light))
+		{
+			mClusteredLight->addLight(light);
+			continue;
+		}
+		ProfileZone lightZone("Light", light->getName().c_str());
 		Ogre::LightList ll;
 		ll.push_back(light);
 
@@ -104,27 +126,25 @@ void RenderOperation::execute(Ogre::SceneManager *sm, Ogre::RenderSystem *rs)
 		dLight->updateFromCamera(cam);
 		tech = dLight->getMaterial()->getBestTechnique();
 
-		// Update shadow textures
+		// Update the shadow map tile, only rendered again when the light or its casters moved
 		if (dLight->getCastShadows())
 		{
-			// Render textures
-			Ogre::SceneManager::RenderContext* context = sm->_pauseRendering();
-			sm->prepareShadowTextures(cam, mViewport, &ll);
-			sm->_resumeRendering(context);
-			
-			// Load textures
-			Ogre::Pass* pass = tech->getPass(0);
-			Ogre::TextureUnitState* tus = pass->getTextureUnitState("ShadowMap");
-			assert(tus);
-
-			// Assign textures
-			const Ogre::TexturePtr& shadowTex = sm->getShadowTexture(0);
-			if (tus->_getTexturePtr() != shadowTex)
+			// No room left in the atlas : the light is skipped this frame
+			if (!mShadowAtlas->updateLight(light, cam, mViewport))
 			{
-				tus->_setTexturePtr(shadowTex);
+				continue;
 			}
-			
+			mShadowAtlas->bindLight(light, tech->getPass(0));
 		}
         injectTechnique(sm, tech, dLight, &ll);
 	}
+
+	// Clustered point lights in one fullscreen pass
+	if (mClusteredLight && mClusteredLight->getLightCount() > 0)
+	{
+		ProfileZone clusterZone("Clusters");
+		mClusteredLight->updateFromCamera(cam);
+		tech = mClusteredLight->getMaterial()->getBestTechnique();
+		injectTechnique(sm, tech, mClusteredLight, 0);
+	}
 }
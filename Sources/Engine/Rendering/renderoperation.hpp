@@ -12,6 +12,8 @@
 #include "Engine/Rendering/renderer.hpp"
 #include "Engine/Rendering/ambient.hpp"
 #include "Engine/Rendering/deferredlight.hpp"
+#include "Engine/Rendering/clusteredlight.hpp"
+#include "Engine/Rendering/shadowatlas.hpp"
 #include "Engine/Rendering/lightmaterial.hpp"
 #include "OgreCustomCompositionPass.h"
 
@@ -29,8 +31,10 @@ public:
 	 * @brief Render operation constructor
 	 * @param instance			Current compositor
 	 * @param pass				Pass data
+	 * @param clustered			Clustered point lights, or NULL for light volumes
+	 * @param shadows			Shadow map atlas
 	 **/
-	RenderOperation(Ogre::CompositorInstance* instance, const Ogre::CompositionPass* pass);
+	RenderOperation(Ogre::CompositorInstance* instance, const Ogre::CompositionPass* pass, ClusteredLight* clustered, ShadowAtlas* shadows);
 	
 	/**
 	 * @brief Render operation destructor
@@ -67,6 +71,8 @@ private:
 	typedef std::map<Ogre::Light*, DeferredLight*> LightsMap;
 	LightsMap mLights;
 	AmbientLight* mAmbientLight;
+	ClusteredLight* mClusteredLight;
+	ShadowAtlas* mShadowAtlas;
 
 };
 
@@ -80,10 +86,41 @@ class DeferredRenderPass : public Ogre::CustomCompositionPass
 
 public:
 
+	/**
+	 * @brief Read the lighting settings
+	 * @param s					System config
+	 **/
+	DeferredRenderPass(tinyxml2::XMLElement* s)
+	{
+		tinyxml2::XMLElement* config = s->FirstChildElement("renderer");
+		assert(config != NULL);
+		bClustered = (Ogre::String(config->FirstChildElement("lighting")->Attribute("value")) == "clustered");
+		mTileSize = config->FirstChildElement("clusterTileSize")->IntAttribute("value");
+		mSlices = config->FirstChildElement("clusterSlices")->IntAttribute("value");
+		mMaxLights = config->FirstChildElement("clusterMaxLights")->IntAttribute("value");
+		mMaxIndices = config->FirstChildElement("clusterMaxIndices")->IntAttribute("value");
+		mShadowAtlasSize = config->FirstChildElement("shadowAtlasSize")->IntAttribute("value");
+		mShadowMaxTile = config->FirstChildElement("shadowRes")->IntAttribute("value");
+		mShadowMinTile = config->FirstChildElement("shadowMinRes")->IntAttribute("value");
+		mCascadeCount = config->FirstChildElement("shadowCascades")->IntAttribute("value");
+		mCascadeSize = config->FirstChildElement("shadowCascadeRes")->IntAttribute("value");
+		mCascadeDistance = config->FirstChildElement("shadowCascadeDistance")->FloatAttribute("value");
+		mCascadeBlend = config->FirstChildElement("shadowCascadeSplit")->FloatAttribute("value");
+		mCascadeRate = config->FirstChildElement("shadowCascadeRate")->IntAttribute("value");
+	}
+
 	virtual Ogre::CompositorInstance::RenderSystemOperation* createOperation(
 		Ogre::CompositorInstance* instance, const Ogre::CompositionPass* pass)
 	{
-		return new RenderOperation(instance, pass);
+		ClusteredLight* clustered = NULL;
+		if (bClustered)
+		{
+			clustered = new ClusteredLight(mTileSize, mSlices, mMaxLights, mMaxIndices);
+		}
+		Ogre::SceneManager* sm = instance->getChain()->getViewport()->getCamera()->getSceneManager();
+		ShadowAtlas* shadows = new ShadowAtlas(sm, mShadowAtlasSize, mShadowMaxTile, mShadowMinTile);
+		shadows->setCascades(mCascadeCount, mCascadeSize, mCascadeDistance, mCascadeBlend, mCascadeRate);
+		return new RenderOperation(instance, pass, clustered, shadows);
 	}
 
 protected:
@@ -91,6 +128,25 @@ protected:
 	virtual ~DeferredRenderPass()
 	{
 	}
+
+	// Clustered lighting settings
+	bool bClustered;
+	int mTileSize;
+	int mSlices;
+	int mMaxLights;
+	int mMaxIndices;
+
+	// Shadow atlas settings
+	int mShadowAtlasSize;
+	int mShadowMaxTile;
+	int mShadowMinTile;
+
+	// Sun cascade settings
+	int mCascadeCount;
+	int mCascadeSize;
+	float mCascadeDistance;
+	float mCascadeBlend;
+	int mCascadeRate;
 };
 
 
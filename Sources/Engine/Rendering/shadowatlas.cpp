@@ -0,0 +1,547 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#include "Engine/Rendering/shadowatlas.hpp"
+#include "Engine/Rendering/deferredlight.hpp"
+#include "Engine/profiler.hpp"
+
+
+/*----------------------------------------------
+	Constructor & destructor
+----------------------------------------------*/
+
+ShadowAtlas::ShadowAtlas(Ogre::SceneManager* sm, int size, int maxTile, int minTile)
+	: mScene(sm), mSize(size)
+{
+	static int sInstanceCount = 0;
+	mBaseName = "ShadowAtlas/" + StringConverter::toString(sInstanceCount++) + "/";
+	mMaxTile = std::min(maxTile, mSize);
+	mMinTile = std::min(minTile, mMaxTile);
+	mNextZOrder = 0;
+	mFrame = 0;
+	mRenderCount = 0;
+	mCachedCount = 0;
+	setCascades(1, mMaxTile, sm->getShadowFarDistance(), 0, 1);
+
+	// Distances stored like the scene manager shadow textures, in full float for the long sun cascades
+	mTexture = Ogre::TextureManager::getSingleton().createManual(mBaseName + "Texture",
+		Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+		Ogre::TEX_TYPE_2D, mSize, mSize, 0, Ogre::PF_FLOAT32_R,
+		Ogre::TU_RENDERTARGET);
+	mTarget = mTexture->getBuffer()->getRenderTarget();
+	mTarget->setAutoUpdated(false);
+
+	// Block levels down to the smallest tile, the whole atlas is free
+	mFreeBlocks.resize(getLevel(mMinTile) + 1);
+	mFreeBlocks[0].push_back(0);
+	mFreeBlocks[0].push_back(0);
+
+	// Caster technique for materials without their own
+	Ogre::MaterialPtr caster = Ogre::MaterialManager::getSingleton().getByName("Render/ShadowCaster");
+	assert(caster.isNull() == false);
+	caster->load();
+	mCasterTechnique = caster->getBestTechnique();
+
+	// Caster query, lights moving around are not casters
+	mQuery = mScene->createAABBQuery(Ogre::AxisAlignedBox());
+	mQuery->setQueryTypeMask(~Ogre::SceneManager::LIGHT_TYPE_MASK);
+}
+
+
+ShadowAtlas::~ShadowAtlas()
+{
+	mTarget->removeAllViewports();
+	for (TileMap::iterator it = mTiles.begin(); it != mTiles.end(); it++)
+	{
+		mScene->destroyCamera(it->second.camera);
+	}
+	mScene->destroyQuery(mQuery);
+	Ogre::TextureManager::getSingleton().remove(mTexture->getName());
+}
+
+
+/*----------------------------------------------
+	Lights
+----------------------------------------------*/
+
+void ShadowAtlas::setCascades(int count, int size, Real distance, Real splitBlend, int updateRate)
+{
+	mCascadeCount = Math::Clamp(count, 1, SHADOW_CASCADES);
+	mCascadeSize = Math::Clamp(size, mMinTile, mSize);
+	mCascadeDistance = distance;
+	mCascadeBlend = Math::Clamp(splitBlend, (Real)0, (Real)1);
+	mCascadeRate = std::max(updateRate, 1);
+	for (int i = 0; i < SHADOW_CASCADES; i++)
+	{
+		mCascadeSplits[i] = mCascadeDistance;
+	}
+}
+
+
+void ShadowAtlas::beginFrame()
+{
+	mFrame++;
+	mRenderCount = 0;
+	mCachedCount = 0;
+}
+
+
+bool ShadowAtlas::updateLight(Ogre::Light* light, Ogre::Camera* camera, Ogre::Viewport* vp)
+{
+	if (light->getType() == Ogre::Light::LT_DIRECTIONAL)
+	{
+		return updateCascades(light, camera);
+	}
+	Tile& tile = getTile(light, 0);
+	if (!placeTile(tile, getTileSize(light, camera, vp)))
+	{
+		return false;
+	}
+
+	// Shadow camera for this frame, as the scene manager would set it
+	tile.camera->setNearClipDistance(light->_deriveShadowNearClipDistance(camera));
+	tile.camera->setFarClipDistance(light->_deriveShadowFarClipDistance(camera));
+	if (light->getType() != Ogre::Light::LT_POINT)
+	{
+		tile.camera->setDirection(light->getDerivedDirection());
+	}
+	tile.camera->setPosition(light->getDerivedPosition());
+	Ogre::ShadowCameraSetupPtr setup = light->getCustomShadowCameraSetup();
+	if (setup.isNull())
+	{
+		setup = mScene->getShadowCameraSetup();
+	}
+	setup->getShadowCamera(mScene, camera, vp, light, tile.camera, 0);
+
+	updateTile(light, tile);
+	return true;
+}
+
+
+void ShadowAtlas::bindLight(Ogre::Light* light, Ogre::Pass* pass)
+{
+	// Atlas texture
+	Ogre::TextureUnitState* tus = pass->getTextureUnitState("ShadowMap");
+	assert(tus);
+	if (tus->_getTexturePtr() != mTexture)
+	{
+		tus->_setTexturePtr(mTexture);
+	}
+	Ogre::GpuProgramParametersSharedPtr params = pass->getFragmentProgramParameters();
+
+	// Cascade tiles, the unused ones repeat the last cascade
+	if (light->getType() == Ogre::Light::LT_DIRECTIONAL)
+	{
+		Ogre::Matrix4 matrices[SHADOW_CASCADES];
+		Ogre::Vector4 tiles[SHADOW_CASCADES];
+		Ogre::Vector4 positions[SHADOW_CASCADES];
+		for (int i = 0; i < SHADOW_CASCADES; i++)
+		{
+			TileMap::iterator it = mTiles.find(TileKey(light, std::min(i, mCascadeCount - 1)));
+			assert(it != mTiles.end());
+			const Tile& tile = it->second;
+			Real scale = (Real)tile.size / mSize;
+			Vector3 position = tile.camera->getDerivedPosition();
+			matrices[i] = tile.textureMatrix;
+			tiles[i] = Ogre::Vector4((Real)tile.x / mSize, (Real)tile.y / mSize, scale, scale);
+			positions[i] = Ogre::Vector4(position.x, position.y, position.z, tile.camera->getFarClipDistance());
+		}
+		params->setNamedConstant("shadowCascadeMat", matrices, SHADOW_CASCADES);
+		params->setNamedConstant("shadowCascadeTile", tiles[0].ptr(), SHADOW_CASCADES);
+		params->setNamedConstant("shadowCascadePos", positions[0].ptr(), SHADOW_CASCADES);
+		params->setNamedConstant("shadowCascadeSplits", Ogre::Vector4(mCascadeSplits));
+		return;
+	}
+
+	// Light tile
+	TileMap::iterator it = mTiles.find(TileKey(light, 0));
+	assert(it != mTiles.end());
+	const Tile& tile = it->second;
+	Real scale = (Real)tile.size / mSize;
+	params->setNamedConstant("shadowViewProjMat", tile.textureMatrix);
+	params->setNamedConstant("shadowTile", Ogre::Vector4((Real)tile.x / mSize, (Real)tile.y / mSize, scale, scale));
+	params->setNamedConstant("shadowFarClip", tile.camera->getFarClipDistance());
+}
+
+
+int ShadowAtlas::getRenderCount()
+{
+	return mRenderCount;
+}
+
+
+int ShadowAtlas::getCachedCount()
+{
+	return mCachedCount;
+}
+
+
+bool ShadowAtlas::renderableQueued(Ogre::Renderable* rend, Ogre::uint8 groupID,
+	Ogre::ushort priority, Ogre::Technique** ppTech, Ogre::RenderQueue* pQueue)
+{
+	if (!rend->getCastsShadows())
+	{
+		return false;
+	}
+
+	// Instanced materials have their own caster
+	Ogre::MaterialPtr caster;
+	if (*ppTech)
+	{
+		caster = (*ppTech)->getShadowCasterMaterial();
+	}
+	if (caster.isNull())
+	{
+		*ppTech = mCasterTechnique;
+	}
+	else
+	{
+		caster->load();
+		*ppTech = caster->getBestTechnique();
+	}
+	return true;
+}
+
+
+/*----------------------------------------------
+	Cascades
+----------------------------------------------*/
+
+bool ShadowAtlas::updateCascades(Ogre::Light* light, Ogre::Camera* camera)
+{
+	// Split distances, blending uniform and logarithmic splits
+	Real nearClip = camera->getNearClipDistance();
+	for (int i = 0; i < mCascadeCount; i++)
+	{
+		Real ratio = (Real)(i + 1) / mCascadeCount;
+		Real logSplit = nearClip * Math::Pow(mCascadeDistance / nearClip, ratio);
+		Real uniformSplit = nearClip + (mCascadeDistance - nearClip) * ratio;
+		mCascadeSplits[i] = mCascadeBlend * logSplit + (1 - mCascadeBlend) * uniformSplit;
+	}
+
+	for (int i = 0; i < mCascadeCount; i++)
+	{
+		Tile& tile = getTile(light, i);
+		if (!placeTile(tile, mCascadeSize))
+		{
+			return false;
+		}
+
+		// Distant cascades are rendered less often, on different frames
+		int period = 1;
+		for (int j = 0; j < i; j++)
+		{
+			period *= mCascadeRate;
+		}
+		if (tile.bValid && (mFrame + i) % period != 0)
+		{
+			mCachedCount++;
+			continue;
+		}
+
+		fitCascade(light, camera, (i > 0) ? mCascadeSplits[i - 1] : nearClip, mCascadeSplits[i], tile);
+		updateTile(light, tile);
+	}
+
+	return true;
+}
+
+
+void ShadowAtlas::fitCascade(Ogre::Light* light, Ogre::Camera* camera, Real nearSplit, Real farSplit, Tile& tile)
+{
+	// Bounding sphere of the view slice, its radius does not change when the camera turns
+	Real tanY = Math::Tan(camera->getFOVy() / 2);
+	Real tanX = tanY * camera->getAspectRatio();
+	Real diagonal = tanX * tanX + tanY * tanY;
+	Real centerDistance = std::min((nearSplit + farSplit) * (1 + diagonal) / 2, farSplit);
+	Real radius = std::max(
+		Math::Sqrt(Math::Sqr(centerDistance - nearSplit) + Math::Sqr(nearSplit) * diagonal),
+		Math::Sqrt(Math::Sqr(farSplit - centerDistance) + Math::Sqr(farSplit) * diagonal));
+	Vector3 center = camera->getDerivedPosition() + camera->getDerivedDirection() * centerDistance;
+
+	// Light axes, the shadow camera looks along the light
+	Vector3 zAxis = -light->getDerivedDirection().normalisedCopy();
+	Vector3 up = (Math::Abs(zAxis.y) < 0.99f) ? Vector3::UNIT_Y : Vector3::UNIT_X;
+	Vector3 xAxis = up.crossProduct(zAxis).normalisedCopy();
+	Vector3 yAxis = zAxis.crossProduct(xAxis);
+
+	// Move the center by whole texels across the light so that the shadow edges do not shimmer, one texel of margin
+	Real texel = 2 * radius / (tile.size - 2);
+	Real window = texel * tile.size;
+	Real x = Math::Floor(center.dotProduct(xAxis) / texel) * texel;
+	Real y = Math::Floor(center.dotProduct(yAxis) / texel) * texel;
+	center = xAxis * x + yAxis * y + zAxis * center.dotProduct(zAxis);
+
+	// Casters up to the shadow range toward the light still shadow the slice
+	tile.camera->setProjectionType(Ogre::PT_ORTHOGRAPHIC);
+	tile.camera->setOrthoWindow(window, window);
+	tile.camera->setNearClipDistance(1);
+	tile.camera->setFarClipDistance(mCascadeDistance + 2 * radius);
+	tile.camera->setOrientation(Quaternion(xAxis, yAxis, zAxis));
+	tile.camera->setPosition(center + zAxis * (mCascadeDistance + radius));
+}
+
+
+/*----------------------------------------------
+	Tiles
+----------------------------------------------*/
+
+ShadowAtlas::Tile& ShadowAtlas::getTile(Ogre::Light* light, int cascade)
+{
+	// New light : camera and viewport, placed later
+	TileMap::iterator it = mTiles.find(TileKey(light, cascade));
+	if (it == mTiles.end())
+	{
+		Tile tile;
+		tile.size = 0;
+		tile.requestedSize = 0;
+		tile.bValid = false;
+		tile.camera = mScene->createCamera(mBaseName + StringConverter::toString(mNextZOrder));
+		tile.viewport = mTarget->addViewport(tile.camera, mNextZOrder++);
+		tile.viewport->setAutoUpdated(false);
+		tile.viewport->setClearEveryFrame(true, Ogre::FBT_COLOUR | Ogre::FBT_DEPTH);
+		tile.viewport->setBackgroundColour(Ogre::ColourValue::White);
+		tile.viewport->setOverlaysEnabled(false);
+		tile.viewport->setSkiesEnabled(false);
+		tile.viewport->setShadowsEnabled(false);
+		it = mTiles.insert(std::make_pair(TileKey(light, cascade), tile)).first;
+	}
+	it->second.lastFrame = mFrame;
+	return it->second;
+}
+
+
+int ShadowAtlas::getTileSize(Ogre::Light* light, Ogre::Camera* camera, Ogre::Viewport* vp)
+{
+	// Screen height covered by the light sphere, in pixels
+	Real radius = DeferredLight::getAttenuationRadius(light);
+	Real distance = camera->getDerivedPosition().distance(light->getDerivedPosition());
+	if (distance <= radius)
+	{
+		return mMaxTile;
+	}
+	Real pixels = vp->getActualHeight() * radius / (distance * Math::Tan(camera->getFOVy() / 2));
+
+	// Smallest tile that covers it
+	int size = mMinTile;
+	while (size < mMaxTile && size < pixels)
+	{
+		size *= 2;
+	}
+	return size;
+}
+
+
+bool ShadowAtlas::placeTile(Tile& tile, int size)
+{
+	// Keep the place until the wanted size changed enough, so that tiles do not flicker between sizes,
+	// compared with the size asked for since a full atlas can give a smaller tile
+	if (tile.size > 0 && size <= tile.requestedSize && 4 * size > tile.requestedSize)
+	{
+		return true;
+	}
+	if (tile.size > 0)
+	{
+		release(getLevel(tile.size), tile.x, tile.y);
+	}
+	tile.size = 0;
+	tile.requestedSize = size;
+	tile.bValid = false;
+
+	int level = getLevel(size);
+	int maxLevel = (int)mFreeBlocks.size() - 1;
+	while (true)
+	{
+		if (allocate(level, tile.x, tile.y))
+		{
+			tile.size = mSize >> level;
+			Real scale = (Real)tile.size / mSize;
+			tile.viewport->setDimensions((Real)tile.x / mSize, (Real)tile.y / mSize, scale, scale);
+			return true;
+		}
+
+		// Take back the tiles of the lights not seen this frame, then try smaller tiles
+		bool bEvicted = false;
+		for (TileMap::iterator it = mTiles.begin(); it != mTiles.end(); it++)
+		{
+			Tile& other = it->second;
+			if (other.size > 0 && other.lastFrame < mFrame)
+			{
+				release(getLevel(other.size), other.x, other.y);
+				other.size = 0;
+				other.bValid = false;
+				bEvicted = true;
+			}
+		}
+		if (!bEvicted)
+		{
+			if (level >= maxLevel)
+			{
+				return false;
+			}
+			level++;
+		}
+	}
+}
+
+
+bool ShadowAtlas::allocate(int level, int& x, int& y)
+{
+	Ogre::vector<int>::type& blocks = mFreeBlocks[level];
+	if (blocks.size() > 0)
+	{
+		x = blocks[blocks.size() - 2];
+		y = blocks[blocks.size() - 1];
+		blocks.resize(blocks.size() - 2);
+		return true;
+	}
+
+	// Split a larger block, its three other quarters are free
+	if (level == 0 || !allocate(level - 1, x, y))
+	{
+		return false;
+	}
+	int size = mSize >> level;
+	blocks.push_back(x + size);
+	blocks.push_back(y);
+	blocks.push_back(x);
+	blocks.push_back(y + size);
+	blocks.push_back(x + size);
+	blocks.push_back(y + size);
+	return true;
+}
+
+
+void ShadowAtlas::release(int level, int x, int y)
+{
+	Ogre::vector<int>::type& blocks = mFreeBlocks[level];
+	int size = mSize >> level;
+
+	// Merge with the three other quarters of the parent when they are free
+	if (level > 0)
+	{
+		int parentX = x - x % (2 * size);
+		int parentY = y - y % (2 * size);
+		Ogre::vector<size_t>::type siblings;
+		for (size_t i = 0; i < blocks.size(); i += 2)
+		{
+			if (blocks[i] >= parentX && blocks[i] < parentX + 2 * size
+			 && blocks[i + 1] >= parentY && blocks[i + 1] < parentY + 2 * size)
+			{
+				siblings.push_back(i);
+			}
+		}
+		if (siblings.size() == 3)
+		{
+			for (int i = 2; i >= 0; i--)
+			{
+				blocks.erase(blocks.begin() + siblings[i], blocks.begin() + siblings[i] + 2);
+			}
+			release(level - 1, parentX, parentY);
+			return;
+		}
+	}
+
+	blocks.push_back(x);
+	blocks.push_back(y);
+}
+
+
+int ShadowAtlas::getLevel(int size)
+{
+	int level = 0;
+	while ((mSize >> level) > size)
+	{
+		level++;
+	}
+	return level;
+}
+
+
+/*----------------------------------------------
+	Rendering
+----------------------------------------------*/
+
+void ShadowAtlas::getCasters(Tile& tile, Ogre::Vector4* casters)
+{
+	// Bounds of the shadow camera frustum
+	const Ogre::Vector3* corners = tile.camera->getWorldSpaceCorners();
+	Ogre::AxisAlignedBox bounds;
+	for (int i = 0; i < 8; i++)
+	{
+		bounds.merge(corners[i]);
+	}
+	mQuery->setBox(bounds);
+
+	// Sums of the caster bounds and orientations, that any move changes
+	casters[0] = Ogre::Vector4::ZERO;
+	casters[1] = Ogre::Vector4::ZERO;
+	casters[2] = Ogre::Vector4::ZERO;
+	Ogre::SceneQueryResultMovableList& movables = mQuery->execute().movables;
+	for (Ogre::SceneQueryResultMovableList::iterator it = movables.begin(); it != movables.end(); it++)
+	{
+		Ogre::MovableObject* object = *it;
+		if (!object->getCastShadows() || !object->isVisible())
+		{
+			continue;
+		}
+		const Ogre::AxisAlignedBox& box = object->getWorldBoundingBox(true);
+		if (box.isFinite())
+		{
+			Vector3 min = box.getMinimum();
+			Vector3 max = box.getMaximum();
+			casters[0] += Ogre::Vector4(min.x, min.y, min.z, 1);
+			casters[1] += Ogre::Vector4(max.x, max.y, max.z, 0);
+		}
+		if (object->getParentNode())
+		{
+			Quaternion q = object->getParentNode()->_getDerivedOrientation();
+			casters[2] += Ogre::Vector4(q.x, q.y, q.z, q.w);
+		}
+	}
+}
+
+
+void ShadowAtlas::updateTile(Ogre::Light* light, Tile& tile)
+{
+	Ogre::Matrix4 viewProj = tile.camera->getProjectionMatrixWithRSDepth() * tile.camera->getViewMatrix();
+	Ogre::Vector4 casters[3];
+	getCasters(tile, casters);
+
+	// Nothing moved : keep the shadow map
+	if (tile.bValid && viewProj == tile.viewProj
+		&& casters[0] == tile.casters[0] && casters[1] == tile.casters[1] && casters[2] == tile.casters[2])
+	{
+		mCachedCount++;
+		return;
+	}
+
+	// Render again
+	tile.viewProj = viewProj;
+	tile.textureMatrix = Ogre::Matrix4::CLIPSPACE2DTOIMAGESPACE * viewProj;
+	for (int i = 0; i < 3; i++)
+	{
+		tile.casters[i] = casters[i];
+	}
+	render(light, tile);
+	tile.bValid = true;
+}
+
+
+void ShadowAtlas::render(Ogre::Light* light, Tile& tile)
+{
+	ProfileZone zone("ShadowMap", light->getName().c_str());
+
+	// The paused scene manager gives a new render queue, that only takes casters
+	Ogre::SceneManager::RenderContext* context = mScene->_pauseRendering();
+	mScene->getRenderQueue()->setRenderableListener(this);
+	mTarget->_beginUpdate();
+	mTarget->_updateViewport(tile.viewport, false);
+	mTarget->_endUpdate();
+	mScene->_resumeRendering(context);
+	mRenderCount++;
+}
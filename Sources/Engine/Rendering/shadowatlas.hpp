@@ -0,0 +1,244 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#ifndef __SHADOW_ATLAS_H_
+#define __SHADOW_ATLAS_H_
+
+#include "Engine/Rendering/renderer.hpp"
+#include "Engine/gametypes.hpp"
+
+// Directional light cascade capacity, as declared in PS_LightMaterial.glsl
+#define SHADOW_CASCADES		4
+
+
+/*----------------------------------------------
+	Shadow map atlas
+----------------------------------------------*/
+
+/**
+ * Shadow maps of all lights in one render texture, split into power-of-two tiles
+ * sized after the light screen coverage. A tile is rendered again only when its
+ * shadow camera or a shadow caster inside its frustum changed since the last time.
+ * Directional lights get one tile per cascade, each fitted to a slice of the view.
+ **/
+class ShadowAtlas : public Ogre::RenderQueue::RenderableListener
+{
+
+public:
+
+	/**
+	 * @brief Create the atlas texture
+	 * @param sm			Scene manager
+	 * @param size			Atlas size in texels
+	 * @param maxTile		Largest tile size in texels
+	 * @param minTile		Smallest tile size in texels
+	 **/
+	ShadowAtlas(Ogre::SceneManager* sm, int size, int maxTile, int minTile);
+
+	/**
+	 * @brief Destroy the atlas texture
+	 **/
+	~ShadowAtlas();
+
+	/**
+	 * @brief Set the directional light cascades
+	 * @param count			Cascade count, up to SHADOW_CASCADES
+	 * @param size			Cascade tile size in texels
+	 * @param distance		Shadow range from the camera
+	 * @param splitBlend	Split scheme, from 0 for uniform splits to 1 for logarithmic splits
+	 * @param updateRate	Cascade N is rendered every updateRate^N frames, 1 for every frame
+	 **/
+	void setCascades(int count, int size, Real distance, Real splitBlend, int updateRate);
+
+	/**
+	 * @brief Start a new frame, tiles of the lights not seen since can be reused
+	 **/
+	void beginFrame();
+
+	/**
+	 * @brief Get a tile for a light and render its shadow map if anything moved
+	 * @param light			Shadow casting light
+	 * @param camera		Player camera
+	 * @param vp			Player viewport
+	 * @return false if the atlas is full
+	 **/
+	bool updateLight(Ogre::Light* light, Ogre::Camera* camera, Ogre::Viewport* vp);
+
+	/**
+	 * @brief Set the atlas texture and the light tiles on a light pass
+	 * @param light			Shadow casting light, updated this frame
+	 * @param pass			Light pass with a ShadowMap texture unit
+	 **/
+	void bindLight(Ogre::Light* light, Ogre::Pass* pass);
+
+	/**
+	 * @brief Get the number of shadow maps rendered this frame
+	 * @return the render count
+	 **/
+	int getRenderCount();
+
+	/**
+	 * @brief Get the number of shadow maps reused this frame
+	 * @return the cached count
+	 **/
+	int getCachedCount();
+
+	/**
+	 * @brief Use the shadow caster technique of a queued object
+	 * @param rend			Queued object
+	 * @param groupID		Render queue group
+	 * @param priority		Priority in the group
+	 * @param ppTech		Technique to use, replaced
+	 * @param pQueue		Render queue
+	 * @return false for objects that cast no shadow
+	 **/
+	virtual bool renderableQueued(Ogre::Renderable* rend, Ogre::uint8 groupID,
+		Ogre::ushort priority, Ogre::Technique** ppTech, Ogre::RenderQueue* pQueue);
+
+
+protected:
+
+	// Light tile
+	struct Tile
+	{
+		int x;
+		int y;
+		int size;
+		int requestedSize;
+		unsigned long lastFrame;
+		bool bValid;
+		Ogre::Camera* camera;
+		Ogre::Viewport* viewport;
+		Ogre::Matrix4 viewProj;
+		Ogre::Matrix4 textureMatrix;
+		Ogre::Vector4 casters[3];
+	};
+
+	// Tiles are found by light and cascade, zero for other lights
+	typedef std::pair<Ogre::Light*, int> TileKey;
+	typedef Ogre::map<TileKey, Tile>::type TileMap;
+
+	/**
+	 * @brief Get the tile of a light, with its camera and viewport
+	 * @param light			Shadow casting light
+	 * @param cascade		Cascade index, zero for other lights
+	 * @return the tile, not placed yet if new
+	 **/
+	Tile& getTile(Ogre::Light* light, int cascade);
+
+	/**
+	 * @brief Update the cascade tiles of a directional light
+	 * @param light			Directional light
+	 * @param camera		Player camera
+	 * @return false if the atlas is full
+	 **/
+	bool updateCascades(Ogre::Light* light, Ogre::Camera* camera);
+
+	/**
+	 * @brief Set a cascade camera around a slice of the view, moving by whole texels only
+	 * @param light			Directional light
+	 * @param camera		Player camera
+	 * @param nearSplit		Slice start distance
+	 * @param farSplit		Slice end distance
+	 * @param tile			Cascade tile
+	 **/
+	void fitCascade(Ogre::Light* light, Ogre::Camera* camera, Real nearSplit, Real farSplit, Tile& tile);
+
+	/**
+	 * @brief Get the tile size a light needs on screen
+	 * @param light			Shadow casting light
+	 * @param camera		Player camera
+	 * @param vp			Player viewport
+	 * @return the size in texels
+	 **/
+	int getTileSize(Ogre::Light* light, Ogre::Camera* camera, Ogre::Viewport* vp);
+
+	/**
+	 * @brief Place a tile again if its size changed enough, reusing the tiles of unseen lights if needed
+	 * @param tile			Tile to place, its size can be reduced
+	 * @param size			Wanted size in texels
+	 * @return false if there is no room
+	 **/
+	bool placeTile(Tile& tile, int size);
+
+	/**
+	 * @brief Reserve a free block
+	 * @param level			Block level, the atlas is level zero
+	 * @param x				Block position to write
+	 * @param y				Block position to write
+	 * @return false if there is no room
+	 **/
+	bool allocate(int level, int& x, int& y);
+
+	/**
+	 * @brief Free a block, merging it back with its free siblings
+	 * @param level			Block level
+	 * @param x				Block position
+	 * @param y				Block position
+	 **/
+	void release(int level, int x, int y);
+
+	/**
+	 * @brief Get the level of a block size
+	 * @param size			Block size in texels
+	 * @return the level
+	 **/
+	int getLevel(int size);
+
+	/**
+	 * @brief Get a summary of the shadow casters in a tile frustum
+	 * @param tile			Light tile
+	 * @param casters		Three values to write, changed when a caster moves
+	 **/
+	void getCasters(Tile& tile, Ogre::Vector4* casters);
+
+	/**
+	 * @brief Render the shadow map of a tile if its camera or its casters changed
+	 * @param light			Shadow casting light
+	 * @param tile			Light tile, with its camera set for this frame
+	 **/
+	void updateTile(Ogre::Light* light, Tile& tile);
+
+	/**
+	 * @brief Render the shadow map of a tile
+	 * @param light			Shadow casting light
+	 * @param tile			Light tile
+	 **/
+	void render(Ogre::Light* light, Tile& tile);
+
+	// Atlas
+	Ogre::SceneManager* mScene;
+	Ogre::TexturePtr mTexture;
+	Ogre::RenderTarget* mTarget;
+	Ogre::String mBaseName;
+	int mSize;
+	int mMaxTile;
+	int mMinTile;
+	int mNextZOrder;
+
+	// Free blocks per level, stored as x and y pairs
+	Ogre::vector<Ogre::vector<int>::type>::type mFreeBlocks;
+
+	// Cascades
+	int mCascadeCount;
+	int mCascadeSize;
+	int mCascadeRate;
+	Real mCascadeDistance;
+	Real mCascadeBlend;
+	Real mCascadeSplits[SHADOW_CASCADES];
+
+	// Lights
+	TileMap mTiles;
+	Ogre::AxisAlignedBoxSceneQuery* mQuery;
+	Ogre::Technique* mCasterTechnique;
+	unsigned long mFrame;
+	int mRenderCount;
+	int mCachedCount;
+
+};
+
+#endif /* __SHADOW_ATLAS_H_ */
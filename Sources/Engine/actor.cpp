@@ -16,8 +16,10 @@ Actor::Actor(Game* g, String name)
 {
 	mGame = g;
 	mName = name;
+	mTickGroups = TG_NONE;
+	bStatic = false;
 	mNode = g->createGameNode(name);
-	mGame->registerActor(this);
+	mHandle = mGame->registerActor(this);
 }
 
 
@@ -36,6 +38,11 @@ void Actor::preTick(const Ogre::FrameEvent& evt)
 }
 
 
+void Actor::parallelTick(const Ogre::FrameEvent& evt)
+{
+}
+
+
 void Actor::tick(const Ogre::FrameEvent& evt)
 {
 }
@@ -53,6 +60,7 @@ void Actor::attachActor(Actor* obj)
 	gameLog("Actor::attachActor " + target->getName() + " to " + mNode->getName());
 	target->getParent()->removeChild(target);
 	mNode->addChild(target);
+	obj->mParentHandle = mHandle;
 }
 
 
@@ -86,6 +94,16 @@ void Actor::rotate(Quaternion rotator)
 }
 
 
+void Actor::rebase(Vector3 shift)
+{
+	// Attached actors follow their parent
+	if (mNode->getParent() == mGame->getScene()->getRootSceneNode())
+	{
+		mNode->translate(shift, Ogre::Node::TS_PARENT);
+	}
+}
+
+
 /*----------------------------------------------
 	Save
 ----------------------------------------------*/
@@ -93,7 +111,20 @@ void Actor::rotate(Quaternion rotator)
 void Actor::save()
 {
 	setSaveGroup("actor");
-	saveValue(location(), "location");
+
+	// Free actors are saved in full precision world coordinates, independent from the floating origin
+	if (mNode->getParent() == mGame->getScene()->getRootSceneNode())
+	{
+		WorldVector world = getWorldLocation();
+		Ogre::StringStream stream;
+		stream.precision(17);
+		stream << world.x << " " << world.y << " " << world.z;
+		saveValue(stream.str(), "worldLocation");
+	}
+	else
+	{
+		saveValue(location(), "location");
+	}
 	saveValue(rotation(), "rotation");
 }
 
@@ -101,6 +132,21 @@ void Actor::save()
 void Actor::load()
 {
 	setSaveGroup("actor");
+
+	// World coordinates are brought back relative to the current origin
+	String world = loadStringValue("worldLocation");
+	if (world.length() > 0)
+	{
+		WorldVector position;
+		Ogre::StringStream stream(world);
+		stream >> position.x >> position.y >> position.z;
+		setLocation((position - mGame->getWorldOrigin()).toVector3());
+	}
+	else
+	{
+		setLocation(loadVectorValue("location"));
+	}
+	setRotation(loadQuaternionValue("rotation"));
 }
 
 
@@ -128,12 +174,63 @@ Quaternion Actor::rotation()
 
 
 
+WorldVector Actor::getWorldLocation()
+{
+	return mGame->getWorldOrigin() + WorldVector(mNode->_getDerivedPosition());
+}
+
+
 Ogre::SceneNode* Actor::getNode()
 {
 	return mNode;
 }
 
 
+ActorHandle Actor::getHandle()
+{
+	return mHandle;
+}
+
+
+bool Actor::hasParallelTick()
+{
+	return (mTickGroups & TG_PARALLEL) != 0;
+}
+
+
+int Actor::getTickGroups()
+{
+	return mTickGroups;
+}
+
+
+void Actor::setStatic(bool bNewStatic)
+{
+	bStatic = bNewStatic;
+	mGame->refreshTickGroups();
+}
+
+
+bool Actor::isStatic()
+{
+	return bStatic;
+}
+
+
+bool Actor::isAwake()
+{
+	Actor* parent = mGame->getActor(mParentHandle);
+	return (!parent || parent->isAwake());
+}
+
+
+void Actor::addTickGroups(int groups)
+{
+	mTickGroups |= groups;
+	mGame->refreshTickGroups();
+}
+
+
 /*----------------------------------------------
 	Debug facilities
 ----------------------------------------------*/
@@ -24,6 +24,15 @@ class Actor : public Savable
 
 public:
 	
+	// Tick phases, only actors in a group get the matching event
+	enum TickGroup
+	{
+		TG_NONE = 0,
+		TG_PRE = 1,
+		TG_PARALLEL = 2,
+		TG_MAIN = 4
+	};
+	
 	/**
 	 * @brief Create an actor
 	 * @param g				Game actor
@@ -37,11 +46,18 @@ public:
 	virtual ~Actor();
 	
 	/**
-	 * @brief Pre-tick event
+	 * @brief Pre-tick event, see TG_PRE
 	 * @param evt			Frame event
 	 **/
 	virtual void preTick(const Ogre::FrameEvent& evt);
 	
+	/**
+	 * @brief Parallel tick event, runs on any thread after preTick(), see TG_PARALLEL
+	 * @brief Only write this actor's own members, MeshActor::applyForce() and the buffered material parameters here : nodes, bodies and other actors are for tick()
+	 * @param evt			Frame event
+	 **/
+	virtual void parallelTick(const Ogre::FrameEvent& evt);
+	
 	/**
 	 * @brief Main tick event
 	 * @param evt			Frame event
@@ -103,11 +119,60 @@ public:
 	 **/
 	Quaternion rotation();
 	
+	/**
+	 * @brief Get the absolute actor position, independent from the floating origin
+	 * @return the double-precision position
+	 **/
+	WorldVector getWorldLocation();
+	
+	/**
+	 * @brief World origin change : move the actor so that it stays in place
+	 * @param shift			Offset to add to the local position
+	 **/
+	virtual void rebase(Vector3 shift);
+	
 	/**
 	 * @brief Get the current node
 	 * @return the node
 	 **/
 	Ogre::SceneNode* getNode();
+	
+	/**
+	 * @brief Get the handle to use instead of a pointer to this actor
+	 * @return the handle, see Game::getActor()
+	 **/
+	ActorHandle getHandle();
+	
+	/**
+	 * @brief Check if the actor has a parallel tick phase
+	 * @return true if parallelTick() has to be called
+	 **/
+	bool hasParallelTick();
+	
+	/**
+	 * @brief Get the tick phases this actor is in
+	 * @return a TickGroup mask
+	 **/
+	int getTickGroups();
+	
+	/**
+	 * @brief Never tick this actor, whatever its groups
+	 * @param bNewStatic	New state
+	 **/
+	void setStatic(bool bNewStatic);
+	
+	/**
+	 * @brief Is this actor marked static ?
+	 * @return true if static
+	 **/
+	bool isStatic();
+	
+	/**
+	 * @brief Does this actor need its tick events for the current step ?
+	 * Attached actors sleep with the actor they are attached to.
+	 * @return false if the actor can be skipped
+	 **/
+	virtual bool isAwake();
 
 
 protected:
@@ -130,6 +195,12 @@ protected:
 	 **/
 	virtual String getFileName();
 	
+	/**
+	 * @brief Add tick phases to this actor, call it where the events are overridden
+	 * @param groups		TickGroup mask
+	 **/
+	void addTickGroups(int groups);
+	
 	/**
 	 * @brief Write text to the log file
 	 * @param text				Input data
@@ -147,7 +218,11 @@ protected:
 	// Render data
 	String mName;
 	Game* mGame;
+	ActorHandle mHandle;
+	ActorHandle mParentHandle;
 	Ogre::SceneNode* mNode;
+	int mTickGroups;
+	bool bStatic;
 
 };
 
@@ -0,0 +1,140 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#include "Engine/actorregistry.hpp"
+
+
+/*----------------------------------------------
+	Definitions
+----------------------------------------------*/
+
+const Ogre::uint32 INVALID_INDEX = 0xFFFFFFFF;
+
+
+/*----------------------------------------------
+	Actor handle
+----------------------------------------------*/
+
+ActorHandle::ActorHandle()
+	: index(INVALID_INDEX), generation(0)
+{
+}
+
+
+ActorHandle::ActorHandle(Ogre::uint32 i, Ogre::uint32 g)
+	: index(i), generation(g)
+{
+}
+
+
+bool ActorHandle::isValid() const
+{
+	return (index != INVALID_INDEX);
+}
+
+
+bool ActorHandle::operator==(const ActorHandle& other) const
+{
+	return (index == other.index && generation == other.generation);
+}
+
+
+bool ActorHandle::operator!=(const ActorHandle& other) const
+{
+	return !(*this == other);
+}
+
+
+/*----------------------------------------------
+	Registry
+----------------------------------------------*/
+
+ActorRegistry::ActorRegistry()
+{
+}
+
+
+ActorHandle ActorRegistry::add(Actor* ref)
+{
+	Ogre::uint32 slotIndex;
+
+	// Reuse a free slot or create one
+	if (mFreeSlots.size() > 0)
+	{
+		slotIndex = mFreeSlots.back();
+		mFreeSlots.pop_back();
+	}
+	else
+	{
+		Slot slot;
+		slot.generation = 0;
+		slotIndex = (Ogre::uint32)mSlots.size();
+		mSlots.push_back(slot);
+	}
+
+	// Append to the dense array
+	Slot& slot = mSlots[slotIndex];
+	slot.dense = (Ogre::uint32)mActors.size();
+	mActors.push_back(ref);
+	mDenseToSlot.push_back(slotIndex);
+
+	return ActorHandle(slotIndex, slot.generation);
+}
+
+
+bool ActorRegistry::remove(ActorHandle handle)
+{
+	if (get(handle) == NULL)
+	{
+		return false;
+	}
+	Slot& slot = mSlots[handle.index];
+	Ogre::uint32 last = (Ogre::uint32)mActors.size() - 1;
+
+	// Move the last actor into the hole
+	if (slot.dense != last)
+	{
+		mActors[slot.dense] = mActors[last];
+		mDenseToSlot[slot.dense] = mDenseToSlot[last];
+		mSlots[mDenseToSlot[last]].dense = slot.dense;
+	}
+	mActors.pop_back();
+	mDenseToSlot.pop_back();
+
+	// Invalidate the slot
+	slot.dense = INVALID_INDEX;
+	slot.generation++;
+	mFreeSlots.push_back(handle.index);
+	return true;
+}
+
+
+Actor* ActorRegistry::get(ActorHandle handle) const
+{
+	if (handle.index >= mSlots.size())
+	{
+		return NULL;
+	}
+	const Slot& slot = mSlots[handle.index];
+	if (slot.generation != handle.generation || slot.dense == INVALID_INDEX)
+	{
+		return NULL;
+	}
+	return mActors[slot.dense];
+}
+
+
+size_t ActorRegistry::size() const
+{
+	return mActors.size();
+}
+
+
+Actor* ActorRegistry::at(size_t i) const
+{
+	return mActors[i];
+}
@@ -0,0 +1,117 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#ifndef __ACTOR_REGISTRY_H_
+#define __ACTOR_REGISTRY_H_
+
+#include "Engine/Rendering/renderer.hpp"
+
+class Actor;
+
+
+/*----------------------------------------------
+	Actor handle
+----------------------------------------------*/
+
+struct ActorHandle
+{
+	/**
+	 * @brief Create an invalid handle
+	 **/
+	ActorHandle();
+
+	/**
+	 * @brief Create a handle
+	 * @param i				Slot index
+	 * @param g				Slot generation
+	 **/
+	ActorHandle(Ogre::uint32 i, Ogre::uint32 g);
+
+	/**
+	 * @brief Does this handle point to a slot ?
+	 * @return true if it was ever assigned
+	 **/
+	bool isValid() const;
+
+	bool operator==(const ActorHandle& other) const;
+	bool operator!=(const ActorHandle& other) const;
+
+	// Slot data
+	Ogre::uint32 index;
+	Ogre::uint32 generation;
+};
+
+
+/*----------------------------------------------
+	Actor registry (generational slot map)
+----------------------------------------------*/
+
+class ActorRegistry
+{
+
+public:
+
+	/**
+	 * @brief Create an empty registry
+	 **/
+	ActorRegistry();
+
+	/**
+	 * @brief Add an actor in O(1)
+	 * @param ref			Actor reference
+	 * @return a handle that stays valid until removal
+	 **/
+	ActorHandle add(Actor* ref);
+
+	/**
+	 * @brief Remove an actor in O(1), stale handles are ignored
+	 * @param handle		Actor handle
+	 * @return true if an actor was removed
+	 **/
+	bool remove(ActorHandle handle);
+
+	/**
+	 * @brief Resolve a handle
+	 * @param handle		Actor handle
+	 * @return the actor, or NULL if it was removed
+	 **/
+	Actor* get(ActorHandle handle) const;
+
+	/**
+	 * @brief Get the number of live actors
+	 * @return the actor count
+	 **/
+	size_t size() const;
+
+	/**
+	 * @brief Get a live actor from the dense array, order changes on removal
+	 * @param i				Dense index (0 - size())
+	 * @return the actor
+	 **/
+	Actor* at(size_t i) const;
+
+
+protected:
+
+	// Sparse slot : dense index if alive, generation to detect stale handles
+	struct Slot
+	{
+		Ogre::uint32 dense;
+		Ogre::uint32 generation;
+	};
+
+	// Slots
+	Ogre::vector<Slot>::type mSlots;
+	Ogre::vector<Ogre::uint32>::type mFreeSlots;
+
+	// Dense storage for iteration
+	Ogre::vector<Actor*>::type mActors;
+	Ogre::vector<Ogre::uint32>::type mDenseToSlot;
+
+};
+
+#endif /* __ACTOR_REGISTRY_H_ */
@@ -0,0 +1,183 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#include "Engine/asyncsaver.hpp"
+
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+#	define WIN32_LEAN_AND_MEAN
+#	include "windows.h"
+#else
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
+
+
+/*----------------------------------------------
+	Constructor & destructor
+----------------------------------------------*/
+
+AsyncSaver::AsyncSaver()
+{
+	bExiting = false;
+	bWriting = false;
+	bPending = false;
+	mThread = new std::thread(&AsyncSaver::run, this);
+}
+
+
+AsyncSaver::~AsyncSaver()
+{
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		bExiting = true;
+	}
+	mCondition.notify_all();
+	mThread->join();
+	delete mThread;
+}
+
+
+/*----------------------------------------------
+	Public methods
+----------------------------------------------*/
+
+void AsyncSaver::submit(SaveArchive* archive, String path, bool bCompress, SaveListener* listener)
+{
+	SaveArchive* superseded = NULL;
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		if (bPending)
+		{
+			superseded = mPending.archive;
+		}
+		mPending.archive = archive;
+		mPending.path = path;
+		mPending.bCompress = bCompress;
+		mPending.bSuccess = false;
+		mPending.duration = 0;
+		mPending.listener = listener;
+		bPending = true;
+	}
+	mCondition.notify_all();
+
+	// An older snapshot was still waiting : only the latest state matters
+	if (superseded)
+	{
+		delete superseded;
+	}
+}
+
+
+void AsyncSaver::update()
+{
+	Ogre::vector<Job>::type completed;
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		completed.swap(mCompleted);
+	}
+
+	for (size_t i = 0; i < completed.size(); i++)
+	{
+		if (completed[i].listener)
+		{
+			completed[i].listener->saveCompleted(completed[i].path, completed[i].bSuccess, completed[i].duration);
+		}
+	}
+}
+
+
+void AsyncSaver::flush()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	while (bPending || bWriting)
+	{
+		mCondition.wait(lock);
+	}
+}
+
+
+/*----------------------------------------------
+	Private methods
+----------------------------------------------*/
+
+void AsyncSaver::run()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	while (true)
+	{
+		while (!bPending && !bExiting)
+		{
+			mCondition.wait(lock);
+		}
+		if (!bPending)
+		{
+			break;
+		}
+
+		// Swap buffers, the game thread can queue the next snapshot meanwhile
+		Job job = mPending;
+		bPending = false;
+		bWriting = true;
+		lock.unlock();
+
+		write(job);
+		delete job.archive;
+		job.archive = NULL;
+
+		lock.lock();
+		bWriting = false;
+		mCompleted.push_back(job);
+		mCondition.notify_all();
+	}
+}
+
+
+void AsyncSaver::write(Job& job)
+{
+	Ogre::Timer timer;
+	String tmpPath = job.path + ".tmp";
+
+	// Never leave a half-written save behind
+	job.bSuccess = job.archive->writeFile(tmpPath, job.bCompress)
+		&& syncFile(tmpPath)
+		&& replaceFile(tmpPath, job.path);
+	job.duration = timer.getMilliseconds();
+}
+
+
+bool AsyncSaver::syncFile(String path)
+{
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	bool res = (FlushFileBuffers(file) != 0);
+	CloseHandle(file);
+	return res;
+#else
+	int file = open(path.c_str(), O_RDWR);
+	if (file < 0)
+	{
+		return false;
+	}
+	bool res = (fsync(file) == 0);
+	close(file);
+	return res;
+#endif
+}
+
+
+bool AsyncSaver::replaceFile(String from, String to)
+{
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+	return (MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0);
+#else
+	return (rename(from.c_str(), to.c_str()) == 0);
+#endif
+}
@@ -0,0 +1,139 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#ifndef __ASYNC_SAVER_H_
+#define __ASYNC_SAVER_H_
+
+#include "Engine/Rendering/renderer.hpp"
+#include "Engine/savearchive.hpp"
+#include "Engine/gametypes.hpp"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+/*----------------------------------------------
+	Save completion listener
+----------------------------------------------*/
+
+class SaveListener
+{
+
+public:
+
+	virtual ~SaveListener() {}
+
+	/**
+	 * @brief Called on the game thread when a save is on disk
+	 * @param path			Saved file
+	 * @param bSuccess		false if the file could not be written
+	 * @param duration		Background write time in ms
+	 **/
+	virtual void saveCompleted(String path, bool bSuccess, unsigned long duration) = 0;
+
+};
+
+
+/*----------------------------------------------
+	Background save writer
+----------------------------------------------*/
+
+class AsyncSaver
+{
+
+public:
+
+	/**
+	 * @brief Start the writer thread
+	 **/
+	AsyncSaver();
+
+	/**
+	 * @brief Finish the queued saves and stop the writer thread
+	 **/
+	~AsyncSaver();
+
+	/**
+	 * @brief Queue a snapshot, replacing any snapshot that is not being written yet
+	 * @param archive		Filled archive, owned by the saver from now on
+	 * @param path			File path
+	 * @param bCompress		Compress the file if the backend supports it
+	 * @param listener		Completion listener, or NULL
+	 **/
+	void submit(SaveArchive* archive, String path, bool bCompress, SaveListener* listener);
+
+	/**
+	 * @brief Run the completion callbacks, call this on the game thread
+	 **/
+	void update();
+
+	/**
+	 * @brief Wait for all queued saves to be written (blocking)
+	 **/
+	void flush();
+
+
+protected:
+
+	// One snapshot to write
+	struct Job
+	{
+		SaveArchive* archive;
+		String path;
+		bool bCompress;
+		bool bSuccess;
+		unsigned long duration;
+		SaveListener* listener;
+	};
+
+	/**
+	 * @brief Writer thread loop
+	 **/
+	void run();
+
+	/**
+	 * @brief Write a snapshot to a temporary file, sync it, then replace the target
+	 * @param job			Snapshot
+	 **/
+	static void write(Job& job);
+
+	/**
+	 * @brief Flush a file to the disk
+	 * @param path			File path
+	 * @return true if successful
+	 **/
+	static bool syncFile(String path);
+
+	/**
+	 * @brief Replace a file by another one
+	 * @param from			New file
+	 * @param to			Replaced file
+	 * @return true if successful
+	 **/
+	static bool replaceFile(String from, String to);
+
+
+protected:
+
+	// Thread data
+	std::thread* mThread;
+	std::mutex mMutex;
+	std::condition_variable mCondition;
+	bool bExiting;
+
+	// Double buffer : the snapshot being written, the next one
+	bool bWriting;
+	bool bPending;
+	Job mPending;
+
+	// Finished saves, waiting for the game thread
+	Ogre::vector<Job>::type mCompleted;
+
+};
+
+#endif /* __ASYNC_SAVER_H_ */
@@ -0,0 +1,121 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#include "Engine/collisioncache.hpp"
+#include "Engine/hullfile.hpp"
+
+
+/*----------------------------------------------
+	Constructor & destructor
+----------------------------------------------*/
+
+CollisionShapeCache::CollisionShapeCache()
+{
+}
+
+
+CollisionShapeCache::~CollisionShapeCache()
+{
+	for (Ogre::map<String, Entry>::type::iterator it = mEntries.begin(); it != mEntries.end(); it++)
+	{
+		destroy(it->second);
+	}
+}
+
+
+/*----------------------------------------------
+	Public methods
+----------------------------------------------*/
+
+CollisionShapeCache& CollisionShapeCache::get()
+{
+	static CollisionShapeCache instance;
+	return instance;
+}
+
+
+String CollisionShapeCache::makeKey(String mesh, Vector3 scale, bool bOptimize)
+{
+	return mesh + "|" + StringConverter::toString(scale) + "|" + (bOptimize ? "hull" : "mesh");
+}
+
+
+btCollisionShape* CollisionShapeCache::acquire(String key)
+{
+	Ogre::map<String, Entry>::type::iterator it = mEntries.find(key);
+	if (it == mEntries.end())
+	{
+		return NULL;
+	}
+	it->second.refCount++;
+	return it->second.shape;
+}
+
+
+void CollisionShapeCache::insert(String key, btCollisionShape* shape, btStridingMeshInterface* data, HullFile* file)
+{
+	assert(mEntries.find(key) == mEntries.end());
+	Entry entry;
+	entry.shape = shape;
+	entry.data = data;
+	entry.file = file;
+	entry.refCount = 1;
+	mEntries[key] = entry;
+	mKeys[shape] = key;
+}
+
+
+void CollisionShapeCache::release(btCollisionShape* shape)
+{
+	Ogre::map<btCollisionShape*, String>::type::iterator keyIt = mKeys.find(shape);
+	if (keyIt == mKeys.end())
+	{
+		return;
+	}
+	Ogre::map<String, Entry>::type::iterator it = mEntries.find(keyIt->second);
+	it->second.refCount--;
+
+	// Last user gone
+	if (it->second.refCount <= 0)
+	{
+		destroy(it->second);
+		mEntries.erase(it);
+		mKeys.erase(keyIt);
+	}
+}
+
+
+size_t CollisionShapeCache::size()
+{
+	return mEntries.size();
+}
+
+
+/*----------------------------------------------
+	Private methods
+----------------------------------------------*/
+
+void CollisionShapeCache::destroy(Entry& entry)
+{
+	if (entry.shape->isCompound())
+	{
+		btCompoundShape* compound = static_cast<btCompoundShape*>(entry.shape);
+		for (int i = 0; i < compound->getNumChildShapes(); i++)
+		{
+			delete compound->getChildShape(i);
+		}
+	}
+	delete entry.shape;
+	if (entry.data)
+	{
+		delete entry.data;
+	}
+	if (entry.file)
+	{
+		delete entry.file;
+	}
+}
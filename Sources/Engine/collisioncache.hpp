@@ -0,0 +1,98 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#ifndef __COLLISION_CACHE_H_
+#define __COLLISION_CACHE_H_
+
+#include "Engine/Rendering/renderer.hpp"
+#include "Engine/bulletphysics.hpp"
+#include "Engine/gametypes.hpp"
+
+class HullFile;
+
+
+/*----------------------------------------------
+	Collision shape cache
+----------------------------------------------*/
+
+class CollisionShapeCache
+{
+
+public:
+
+	/**
+	 * @brief Get the process-wide cache
+	 * @return the cache
+	 **/
+	static CollisionShapeCache& get();
+
+	/**
+	 * @brief Build the cache key of a shape
+	 * @param mesh			Mesh file
+	 * @param scale			Mesh scale
+	 * @param bOptimize		Hull reduction flag
+	 * @return the key
+	 **/
+	static String makeKey(String mesh, Vector3 scale, bool bOptimize);
+
+	/**
+	 * @brief Get a new reference to a cached shape
+	 * @param key			Shape key
+	 * @return the shape, or NULL if it has to be built
+	 **/
+	btCollisionShape* acquire(String key);
+
+	/**
+	 * @brief Store a new shape, with one reference held by the caller
+	 * @param key			Shape key
+	 * @param shape			Collision shape
+	 * @param data			Mesh data used by the shape, or NULL
+	 * @param file			Mapped hull file used by the shape, or NULL
+	 **/
+	void insert(String key, btCollisionShape* shape, btStridingMeshInterface* data, HullFile* file = NULL);
+
+	/**
+	 * @brief Release a reference, the shape is deleted with the last one
+	 * @param shape			Collision shape
+	 **/
+	void release(btCollisionShape* shape);
+
+	/**
+	 * @brief Get the number of cached shapes
+	 * @return the shape count
+	 **/
+	size_t size();
+
+
+protected:
+
+	CollisionShapeCache();
+
+	~CollisionShapeCache();
+
+	// Cached shape
+	struct Entry
+	{
+		btCollisionShape* shape;
+		btStridingMeshInterface* data;
+		HullFile* file;
+		int refCount;
+	};
+
+	/**
+	 * @brief Delete a shape and the data it uses
+	 * @param entry			Cached shape
+	 **/
+	void destroy(Entry& entry);
+
+	// Shapes by key, and keys by shape for release
+	Ogre::map<String, Entry>::type mEntries;
+	Ogre::map<btCollisionShape*, String>::type mKeys;
+
+};
+
+#endif /* __COLLISION_CACHE_H_ */
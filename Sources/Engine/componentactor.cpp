@@ -6,6 +6,8 @@
 **/
 
 #include "Engine/componentactor.hpp"
+#include "Engine/collisioncache.hpp"
+#include "Engine/hullfile.hpp"
 
 
 /*----------------------------------------------
@@ -16,6 +18,9 @@ ComponentActor::ComponentActor(Game* g, String name)
 	: Actor(g, name)
 {
 	mMesh = NULL;
+	mInstance = NULL;
+	mParamBlock = -1;
+	mCastShadow = true;
 }
 
 
@@ -23,6 +28,9 @@ ComponentActor::ComponentActor(Game* g, String name, String file)
 	: Actor(g, name)
 {
 	mMesh = NULL;
+	mInstance = NULL;
+	mParamBlock = -1;
+	mCastShadow = true;
 	if (file.length() > 0)
 	{
 		setModel(file);
@@ -34,6 +42,9 @@ ComponentActor::ComponentActor(Game* g, String name, String file, String materia
 	: Actor(g, name)
 {
 	mMesh = NULL;
+	mInstance = NULL;
+	mParamBlock = -1;
+	mCastShadow = true;
 	if (file.length() > 0)
 	{
 		setModel(file);
@@ -46,16 +57,28 @@ ComponentActor::ComponentActor(Game* g, String name, String file, String materia
 	: Actor(g, name)
 {
 	mMesh = NULL;
+	mInstance = NULL;
+	mParamBlock = -1;
+	mCastShadow = true;
 	if (file.length() > 0)
 	{
 		setModel(file);
 		setMaterial(material);
-		mMesh->setCastShadows(bCastShadows);
+		setCastShadows(bCastShadows);
 	}
 }
 
 ComponentActor::~ComponentActor()
 {
+	if (mParamBlock >= 0)
+	{
+		mGame->getMaterialParams()->release(mParamBlock);
+	}
+	if (mInstance)
+	{
+		mNode->detachObject(mInstance);
+		mGame->deleteGameInstance(mInstance);
+	}
 }
 
 
@@ -71,17 +94,48 @@ void ComponentActor::tick(const Ogre::FrameEvent& evt)
 
 void ComponentActor::setModel(Ogre::String file)
 {
+	if (mInstance)
+	{
+		mNode->detachObject(mInstance);
+		mGame->deleteGameInstance(mInstance);
+		mInstance = NULL;
+	}
+	if (mMesh)
+	{
+		mNode->detachObject(mMesh);
+		mGame->deleteGameEntity(mMesh);
+		mMesh = NULL;
+	}
+
 	prepareLoad(file);
+	mMeshData = Ogre::MeshManager::getSingleton().getByName(file);
 	mMesh = mGame->createGameEntity(mName + "_mesh", file);
-	mMesh->setCastShadows(true);
-	mNode->attachObject(mMesh);
+	if (mMesh)
+	{
+		mMesh->setCastShadows(mCastShadow);
+		mNode->attachObject(mMesh);
+	}
+
+	// Material parameters are written from the ticks and uploaded once per frame
+	if (mParamBlock < 0)
+	{
+		mParamBlock = mGame->getMaterialParams()->allocate();
+	}
+	mGame->getMaterialParams()->bind(mParamBlock, mMesh, NULL);
 }
 
 void ComponentActor::setCastShadows(bool bCastShadow)
 {
+	bool bChanged = (bCastShadow != mCastShadow);
 	mCastShadow = bCastShadow;
 	if(mMesh) {
-		mMesh->setCastShadows(true);
+		mMesh->setCastShadows(mCastShadow);
+	}
+
+	// Shadows are a batch setting : move to the matching instance manager
+	if (mInstance && bChanged)
+	{
+		setMaterial(mMaterialName);
 	}
 }
 
@@ -257,23 +311,63 @@ void getMeshInformation(const Ogre::Mesh* const mesh,
     }
 }
 
+/**
+ * @brief Map the baked hulls of a mesh, if they exist
+ * @param mesh			OGRE mesh data
+ * @return the hull file, or NULL
+ **/
+HullFile* openHullFile(const Ogre::Mesh* const mesh)
+{
+	String base, ext;
+	StringUtil::splitBaseFilename(mesh->getName(), base, ext);
+	Ogre::FileInfoListPtr info = Ogre::ResourceGroupManager::getSingleton().findResourceFileInfo(mesh->getGroup(), base + ".hull");
+	if (info->empty() || info->front().archive->getType() != "FileSystem")
+	{
+		return NULL;
+	}
+
+	HullFile* file = new HullFile();
+	if (!file->open(info->front().archive->getName() + "/" + info->front().filename) || file->getHullCount() == 0)
+	{
+		delete file;
+		return NULL;
+	}
+	return file;
+}
+
 btCollisionShape* ComponentActor::getCollisionMesh(bool bOptimize)
 {
-	if(!mMesh) {
+	if(mMeshData.isNull()) {
 		return NULL;
 	}
-	
+
+	// Shared shape for this mesh
+	String key = CollisionShapeCache::makeKey(mMeshData->getName(), mNode->getScale(), bOptimize);
+	btCollisionShape* shape = CollisionShapeCache::get().acquire(key);
+	if (shape)
+	{
+		return shape;
+	}
+
+	// Offline hulls : no buffer read, no hull generation
+	HullFile* file = openHullFile(mMeshData.get());
+	if (file)
+	{
+		shape = file->createShape(mNode->getScale());
+		CollisionShapeCache::get().insert(key, shape, NULL, file);
+		return shape;
+	}
 	
 	Vector3* vertices;
 	size_t vCount, iCount;
 	unsigned long* indices;
-	Ogre::Mesh* origin = mMesh->getMesh().get();
-	btCollisionShape* shape;
+	Ogre::Mesh* origin = mMeshData.get();
+	btStridingMeshInterface* data = NULL;
 
-	// Trimesh preparation
+	// Trimesh preparation, orientation is set by the parent's compound transform
 	btTriangleMesh* trimesh = new btTriangleMesh();
 	getMeshInformation(origin, vCount, vertices, iCount, indices,
-		Vector3::ZERO, mNode->getOrientation(), mNode->getScale());
+		Vector3::ZERO, Quaternion::IDENTITY, mNode->getScale());
 
 	// Triangle copy
     btVector3 vertexPos[3];
@@ -281,14 +375,15 @@ btCollisionShape* ComponentActor::getCollisionMesh(bool bOptimize)
 	{
          for (unsigned int i = 0; i < 3; ++i)
          {
-			const Vector3 &vec = vertices[*indices];
+			const Vector3 &vec = vertices[indices[3 * n + i]];
 			vertexPos[i][0] = vec.x;
 			vertexPos[i][1] = vec.y;
 			vertexPos[i][2] = vec.z;
-			*indices++;
          }
          trimesh->addTriangle(vertexPos[0], vertexPos[1], vertexPos[2]);
 	}
+	delete[] vertices;
+	delete[] indices;
 	btConvexTriangleMeshShape* trishape = new btConvexTriangleMeshShape(trimesh, true);
 	
 	// Collision hull generation
@@ -300,13 +395,16 @@ btCollisionShape* ComponentActor::getCollisionMesh(bool bOptimize)
 		shape = new btConvexHullShape((btScalar*)hull->getVertexPointer(), hull->numVertices());
 
 		delete trishape;
+		delete trimesh;
 		delete hull;
 	}
 	else
 	{
 		shape = trishape;
+		data = trimesh;
 	}
 	
+	CollisionShapeCache::get().insert(key, shape, data);
 	return shape;
 }
 
@@ -318,35 +416,84 @@ btCollisionShape* ComponentActor::getCollisionMesh(bool bOptimize)
 void ComponentActor::setMaterial(String name)
 {
 	mMaterialName = name;
-	mMesh->setMaterialName(mMaterialName);
+	if (mMeshData.isNull())
+	{
+		return;
+	}
+	bool bWasInstanced = (mInstance != NULL);
+	if (mInstance)
+	{
+		mNode->detachObject(mInstance);
+		mGame->deleteGameInstance(mInstance);
+	}
+
+	// Shared mesh and material : draw from a hardware instanced batch
+	mInstance = mGame->createGameInstance(mMeshData->getName(), mMaterialName, mCastShadow);
+	if (mInstance)
+	{
+		if (mMesh)
+		{
+			mNode->detachObject(mMesh);
+			mGame->deleteGameEntity(mMesh);
+			mMesh = NULL;
+		}
+		mNode->attachObject(mInstance);
+		mGame->getMaterialParams()->bind(mParamBlock, NULL, mInstance);
+	}
+
+	// Own entity otherwise
+	else
+	{
+		if (bWasInstanced)
+		{
+			setModel(mMeshData->getName());
+		}
+		if (mMesh)
+		{
+			mMesh->setMaterialName(mMaterialName);
+		}
+	}
 }
 
 
 void ComponentActor::setMaterialParam(int index, Real val)
 {
-	int numSubEnt = mMesh->getNumSubEntities();
-	for (int i = 0; i < numSubEnt; i++)
-	{
-		mMesh->getSubEntity(i)->setCustomParameter(index, Vector4(val, val, val, val));
-	}
+	setMaterialParam(index, Vector4(val, val, val, val));
 }
 
 
 void ComponentActor::setMaterialParam(int index, Vector3 val)
 {
-	int numSubEnt = mMesh->getNumSubEntities();
-	for (int i = 0; i < numSubEnt; i++)
-	{
-		mMesh->getSubEntity(i)->setCustomParameter(index, Vector4(val[0], val[1], val[2], 0));
-	}
+	setMaterialParam(index, Vector4(val[0], val[1], val[2], 0));
 }
 
 
 void ComponentActor::setMaterialParam(int index, Vector4 val)
 {
+	setMaterialParams(index, &val, 1);
+}
+
+
+void ComponentActor::setMaterialParams(int first, const Vector4* values, int count)
+{
+	// Buffered parameters
+	if (mParamBlock >= 0 && first >= 0 && first + count <= MATERIAL_PARAM_COUNT)
+	{
+		mGame->getMaterialParams()->set(mParamBlock, first, values, count);
+		return;
+	}
+
+	// Instances only hold the buffered ones, entities get the others immediately
+	if (!mMesh)
+	{
+		return;
+	}
 	int numSubEnt = mMesh->getNumSubEntities();
 	for (int i = 0; i < numSubEnt; i++)
 	{
-		mMesh->getSubEntity(i)->setCustomParameter(index, val);
+		for (int j = 0; j < count; j++)
+		{
+			mMesh->getSubEntity(i)->setCustomParameter(first + j, values[j]);
+		}
 	}
 }
@@ -77,6 +77,10 @@ public:
 	 **/
 	void setModel(Ogre::String file);
 	
+	/**
+	 * @brief Set the shadow casting
+	 * @param bCastShadows	Should cast shadows
+	 **/
 	void setCastShadows(bool bCastShadows);
 
 	/**
@@ -121,7 +125,7 @@ public:
 	Vector3 getLocation();
 	
 	/**
-	 * @brief Set a material
+	 * @brief Set a material, the mesh is instanced when the material allows it
 	 * @param name			Material path
 	 **/
 	void setMaterial(String name);
@@ -146,11 +150,19 @@ public:
 	 * @param val			Parameter value
 	 **/
 	void setMaterialParam(int index, Vector4 val);
+	
+	/**
+	 * @brief Set consecutive material parameters, uploaded with the next frame
+	 * @param first			First parameter index
+	 * @param values		Parameter values
+	 * @param count			Value count
+	 **/
+	void setMaterialParams(int first, const Vector4* values, int count);
 
 	/**
-	 * @brief Generate a hull mesh from the OGRE mesh
+	 * @brief Get the shared collision shape of the OGRE mesh, built on first use
 	 * @param bOptimize		Set to true to enable hull reduction
-	 * @return a hull mesh for Bullet
+	 * @return a hull mesh for Bullet, to release with CollisionShapeCache::release
 	 **/
 	virtual btCollisionShape* getCollisionMesh(bool bOptimize = false);
 
@@ -162,11 +174,13 @@ protected:
 	
 	// Physics data
 	btTransform mLocalPhysTransform;
-	btCollisionShape* mCollisionMeshCache;
 
 	// Game data
 	String mMaterialName;
 	Ogre::Entity* mMesh;
+	Ogre::InstancedEntity* mInstance;
+	int mParamBlock;
+	Ogre::MeshPtr mMeshData;
 	bool mCastShadow;
 };
 
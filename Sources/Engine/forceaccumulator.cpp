@@ -0,0 +1,122 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#include "Engine/forceaccumulator.hpp"
+
+#define FORCE_SCALE			4096.0
+
+
+/*----------------------------------------------
+	Constructor
+----------------------------------------------*/
+
+ForceAccumulator::ForceAccumulator()
+{
+	for (int i = 0; i < 6; i++)
+	{
+		mWorldSum[i] = 0;
+		mLocalSum[i] = 0;
+	}
+	mLastForce.setZero();
+	mLastTorque.setZero();
+	mBody = NULL;
+}
+
+
+/*----------------------------------------------
+	Public methods
+----------------------------------------------*/
+
+void ForceAccumulator::setBody(btRigidBody* body)
+{
+	mBody = body;
+}
+
+
+void ForceAccumulator::addForce(Vector3 force, Vector3 location)
+{
+	add(mWorldSum, force, location);
+}
+
+
+void ForceAccumulator::addLocalForce(Vector3 force, Vector3 location)
+{
+	add(mLocalSum, force, location);
+}
+
+
+void ForceAccumulator::clear()
+{
+	btVector3 force, torque;
+	take(mWorldSum, force, torque);
+	take(mLocalSum, force, torque);
+}
+
+
+void ForceAccumulator::flush()
+{
+	btVector3 force, torque, localForce, localTorque;
+	take(mWorldSum, force, torque);
+	take(mLocalSum, localForce, localTorque);
+	if (!mBody)
+	{
+		return;
+	}
+
+	// One basis multiply per body for all local forces
+	const btMatrix3x3& basis = mBody->getWorldTransform().getBasis();
+	force += basis * localForce;
+	torque += basis * localTorque;
+
+	// Only wake the body up when the command changes, let it sleep when idle
+	btVector3 zero(0, 0, 0);
+	bool bPushing = (force != zero || torque != zero);
+	if (force != mLastForce || torque != mLastTorque)
+	{
+		if (bPushing)
+		{
+			mBody->activate(true);
+		}
+		mLastForce = force;
+		mLastTorque = torque;
+	}
+
+	if (bPushing)
+	{
+		mBody->applyCentralForce(force);
+		mBody->applyTorque(torque);
+	}
+}
+
+
+/*----------------------------------------------
+	Protected methods
+----------------------------------------------*/
+
+void ForceAccumulator::add(std::atomic<int64_t>* sum, Vector3 force, Vector3 location)
+{
+	Vector3 torque = location.crossProduct(force);
+	sum[0].fetch_add((int64_t)llround(force.x * FORCE_SCALE), std::memory_order_relaxed);
+	sum[1].fetch_add((int64_t)llround(force.y * FORCE_SCALE), std::memory_order_relaxed);
+	sum[2].fetch_add((int64_t)llround(force.z * FORCE_SCALE), std::memory_order_relaxed);
+	sum[3].fetch_add((int64_t)llround(torque.x * FORCE_SCALE), std::memory_order_relaxed);
+	sum[4].fetch_add((int64_t)llround(torque.y * FORCE_SCALE), std::memory_order_relaxed);
+	sum[5].fetch_add((int64_t)llround(torque.z * FORCE_SCALE), std::memory_order_relaxed);
+}
+
+
+void ForceAccumulator::take(std::atomic<int64_t>* sum, btVector3& force, btVector3& torque)
+{
+	force.setValue(
+		(btScalar)(sum[0].exchange(0) / FORCE_SCALE),
+		(btScalar)(sum[1].exchange(0) / FORCE_SCALE),
+		(btScalar)(sum[2].exchange(0) / FORCE_SCALE));
+	torque.setValue(
+		(btScalar)(sum[3].exchange(0) / FORCE_SCALE),
+		(btScalar)(sum[4].exchange(0) / FORCE_SCALE),
+		(btScalar)(sum[5].exchange(0) / FORCE_SCALE));
+}
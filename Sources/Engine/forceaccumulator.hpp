@@ -0,0 +1,95 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#ifndef __FORCE_ACCUMULATOR_H_
+#define __FORCE_ACCUMULATOR_H_
+
+#include "Engine/bulletphysics.hpp"
+#include "Engine/gametypes.hpp"
+
+#include <atomic>
+#include <stdint.h>
+
+
+/*----------------------------------------------
+	Per-body force accumulator
+----------------------------------------------*/
+
+class ForceAccumulator
+{
+
+public:
+
+	/**
+	 * @brief Create an empty accumulator
+	 **/
+	ForceAccumulator();
+
+	/**
+	 * @brief Set the body the forces are applied to
+	 * @param body			Rigid body
+	 **/
+	void setBody(btRigidBody* body);
+
+	/**
+	 * @brief Add a force in the world referencial, lock-free
+	 * @param force			Force data
+	 * @param location		Force location relative to the center of mass
+	 **/
+	void addForce(Vector3 force, Vector3 location);
+
+	/**
+	 * @brief Add a force in the body referencial, lock-free
+	 * @param force			Force data
+	 * @param location		Force location relative to the center of mass
+	 **/
+	void addLocalForce(Vector3 force, Vector3 location);
+
+	/**
+	 * @brief Drop the pending forces
+	 **/
+	void clear();
+
+	/**
+	 * @brief Apply the net force to the body and reset, before the physics step
+	 **/
+	void flush();
+
+
+protected:
+
+	/**
+	 * @brief Add a force and its torque to one of the sums
+	 * @param sum			Force X, Y, Z then torque X, Y, Z
+	 * @param force			Force data
+	 * @param location		Force location
+	 **/
+	static void add(std::atomic<int64_t>* sum, Vector3 force, Vector3 location);
+
+	/**
+	 * @brief Read and reset one of the sums
+	 * @param sum			Force X, Y, Z then torque X, Y, Z
+	 * @param force			Output force
+	 * @param torque		Output torque
+	 **/
+	static void take(std::atomic<int64_t>* sum, btVector3& force, btVector3& torque);
+
+
+protected:
+
+	// Fixed-point sums, exact in any order so the result does not depend on threads
+	std::atomic<int64_t> mWorldSum[6];
+	std::atomic<int64_t> mLocalSum[6];
+
+	// Last applied net force
+	btVector3 mLastForce;
+	btVector3 mLastTorque;
+	btRigidBody* mBody;
+
+};
+
+#endif /* __FORCE_ACCUMULATOR_H_ */
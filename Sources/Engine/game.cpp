@@ -10,6 +10,11 @@
 #include "Engine/game.hpp"
 #include "Engine/actor.hpp"
 #include "Engine/player.hpp"
+#include "Engine/savearchive.hpp"
+#include "Engine/profiler.hpp"
+#include "Engine/physicsscheduler.hpp"
+#include "Engine/physicsbenchmark.hpp"
+#include "Engine/motionstate.hpp"
 
 
 #define OGRE_CONF			"Config/soyouz.cfg"
@@ -21,6 +26,32 @@
 #endif
 #define RESOURCES_CONF		"Config/resources.cfg"
 #define LOGFILE_NAME		"Config/soyouz.log"
+#define TEMPLATE_DIR		"Content/Templates/"
+#define SAVE_DIR			"Content/Save/0000/"
+#define PARALLEL_GRAIN		16
+#define PHYSICS_GRAIN		40
+#define PHYSICS_POOL_SIZE	16384
+#define SCENE_MAX_DEPTH		16
+
+
+/*----------------------------------------------
+	Parallel tick job
+----------------------------------------------*/
+
+typedef struct
+{
+	Actor** actors;
+	const Ogre::FrameEvent* evt;
+} ParallelTickData;
+
+static void parallelTickJob(void* data, size_t begin, size_t end)
+{
+	ParallelTickData* tickData = (ParallelTickData*)data;
+	for (size_t i = begin; i < end; i++)
+	{
+		tickData->actors[i]->parallelTick(*tickData->evt);
+	}
+}
 
 
 /*----------------------------------------------
@@ -29,19 +60,85 @@
 
 Game::Game()
 {
+	bRunning = true;
+	bHeadless = false;
+	mHeadlessDuration = 0;
+	mTickStep = 1.0f / 60.0f;
+	mTickAccumulator = 0;
+	mCatchUpBudget = 0;
+	mMaxCatchUpSteps = 4;
+	bDropLateTicks = true;
+	bTickGroupsDirty = true;
+	mOriginDistance = 0;
+	mPlayer = NULL;
 	mRoot = NULL;
+	mScene = NULL;
+	mWindow = NULL;
+	mRenderer = NULL;
+	mInstances = NULL;
+	mMaterialParams = new MaterialParamBuffer();
 	mIOManager = NULL;
+	mPhysBackend = "";
+	mPhysBenchmarkBodies = 0;
+	mPhysMaxPairs = 0;
 	mPhysWorld = NULL;
+	mPhysSolver = NULL;
+	mPhysSolverMt = NULL;
+	mPhysScheduler = NULL;
+	mPhysBenchmark = NULL;
+	mProjectiles = NULL;
+	mJobs = NULL;
+	mTemplates = new TemplateRegistry(TEMPLATE_DIR);
+	mSaver = new AsyncSaver();
+	mAutosaveDelay = 0;
+	mAutosaveTimer = 0;
 	mOverlaySystem = NULL;
+	mBufferManager = NULL;
+	mCullingProfiler = NULL;
 }
 
 
 Game::~Game()
 {
+	delete mSaver;
 	if (mIOManager)
 	{
 		delete mIOManager;
 	}
+	if (mProjectiles)
+	{
+		delete mProjectiles;
+	}
+	delete mTemplates;
+	if (mPhysBenchmark)
+	{
+		delete mPhysBenchmark;
+	}
+#if BT_THREADSAFE
+	if (mPhysScheduler)
+	{
+		btSetTaskScheduler(btGetSequentialTaskScheduler());
+		delete mPhysScheduler;
+	}
+#endif
+	if (mJobs)
+	{
+		delete mJobs;
+	}
+	if (mInstances)
+	{
+		delete mInstances;
+	}
+	delete mMaterialParams;
+	if (mRenderer)
+	{
+		mRenderer->saveShaderCache();
+	}
+	if (mCullingProfiler)
+	{
+		mScene->removeListener(mCullingProfiler);
+		delete mCullingProfiler;
+	}
 	if (mOverlaySystem)
 	{
 		if(mScene) mScene->removeRenderQueueListener(mOverlaySystem);
@@ -51,6 +148,10 @@ Game::~Game()
 	{
 		delete mRoot;
 	}
+	if (mBufferManager)
+	{
+		delete mBufferManager;
+	}
 }
 
 
@@ -61,76 +162,430 @@ Game::~Game()
 void Game::run()
 {
 	setup();
-	mRoot->startRendering();
-	while (!mWindow->isClosed() && mRoot->renderOneFrame())
+	if (bHeadless)
 	{
-	    Ogre::WindowEventUtilities::messagePump();
+		runHeadless();
+	}
+	else
+	{
+		mRoot->startRendering();
+		while (!mWindow->isClosed() && mRoot->renderOneFrame())
+		{
+			Ogre::WindowEventUtilities::messagePump();
+		}
 	}
 	destruct();
 }
 
 
+void Game::setHeadless(bool bNewHeadless, Real duration)
+{
+	bHeadless = bNewHeadless;
+	mHeadlessDuration = duration;
+}
+
+
+bool Game::isHeadless()
+{
+	return bHeadless;
+}
+
+
+void Game::setPhysicsBackend(String backend)
+{
+	mPhysBackend = backend;
+}
+
+
+void Game::setPhysicsBenchmark(int bodyCount)
+{
+	mPhysBenchmarkBodies = bodyCount;
+}
+
+
 void Game::tick(const Ogre::FrameEvent& evt)
 {
-	Actor* ref;
-	
+	int steps = 0;
+	Ogre::FrameEvent stepEvt;
+	stepEvt.timeSinceLastEvent = mTickStep;
+	stepEvt.timeSinceLastFrame = mTickStep;
+
+	// Run the simulation at a constant rate, whatever the frame rate
+	mTickTimer.reset();
+	mTickAccumulator += evt.timeSinceLastFrame;
+	while (mTickAccumulator >= mTickStep)
+	{
+		// Too late : stop catching up, then drop or keep the remaining time
+		bool bOverBudget = (mCatchUpBudget > 0 && steps > 0 && mTickTimer.getMicroseconds() > 1000.0f * mCatchUpBudget);
+		if (steps >= mMaxCatchUpSteps || bOverBudget)
+		{
+			if (bDropLateTicks)
+			{
+				mTickAccumulator = fmod(mTickAccumulator, mTickStep);
+			}
+			else
+			{
+				mTickAccumulator = std::min(mTickAccumulator, mMaxCatchUpSteps * mTickStep);
+			}
+			break;
+		}
+
+		fixedTick(stepEvt);
+		mTickAccumulator -= mTickStep;
+		steps++;
+	}
+
+	// Background saves
+	mSaver->update();
+	mAutosaveTimer += evt.timeSinceLastFrame;
+	if (mAutosaveDelay > 0 && mAutosaveTimer >= mAutosaveDelay)
+	{
+		mAutosaveTimer = 0;
+		saveWorld("autosave");
+	}
+
+	// Render state between the last two steps
+	if (!bHeadless)
+	{
+		ProfileZone zone("Interpolate");
+		interpolate(mTickAccumulator / mTickStep);
+		mProjectiles->render(mTickAccumulator / mTickStep);
+		{
+			ProfileZone paramZone("MaterialParams");
+			mMaterialParams->flush();
+		}
+		{
+			ProfileZone drawerZone("DebugDrawer");
+			mPhysDrawer->step();
+		}
+	}
+}
+
+
+void Game::fixedTick(const Ogre::FrameEvent& evt)
+{
+	ProfileZone zone("Step");
+
 	// Physics tick
 	if (mPhysWorld)
 	{
-		mPhysWorld->stepSimulation(evt.timeSinceLastFrame, 4, btScalar(1.)/btScalar(60.));
+		ProfileZone physZone("Physics");
+		for (size_t i = 0; i < mForceAccumulators.size(); i++)
+		{
+			mForceAccumulators[i]->flush();
+		}
+		mPhysWorld->stepSimulation(mTickStep, 0, mTickStep);
+		mProjectiles->tick(mTickStep);
+		mPhysMaxPairs = std::max(mPhysMaxPairs, mPhysBroadphase->getOverlappingPairCache()->getNumOverlappingPairs());
+	}
+
+	// Bodies that Bullet did not move get a last node update, then leave the list
+	{
+		ProfileZone syncZone("Sync");
+		size_t i = 0;
+		while (i < mMovingBodies.size())
+		{
+			if (mMovingBodies[i]->endStep())
+			{
+				i++;
+			}
+			else
+			{
+				mMovingBodies[i] = mMovingBodies.back();
+				mMovingBodies.pop_back();
+			}
+		}
+	}
+
+	// Awake actors : static, sleeping and non-ticking actors are never visited
+	{
+		ProfileZone wakeZone("Wake");
+		if (bTickGroupsDirty)
+		{
+			updateTickGroups();
+		}
+		mAwakeActors.clear();
+		for (size_t i = 0; i < mTickActors.size(); i++)
+		{
+			Actor* target = mAllActors.get(mTickActors[i]);
+			if (target && target->isAwake())
+			{
+				mAwakeActors.push_back(mTickActors[i]);
+			}
+		}
 	}
 
 	// Actor pre-tick
-	for (Ogre::list<Actor*>::iterator it = mAllActors.begin(); it != mAllActors.end(); it++)
-    {
-		ref = *it;
-        ref->preTick(evt);
-    }
+	{
+		ProfileZone preTickZone("PreTick");
+		for (size_t i = 0; i < mAwakeActors.size(); i++)
+		{
+			Actor* target = mAllActors.get(mAwakeActors[i]);
+			if (target && (target->getTickGroups() & Actor::TG_PRE))
+			{
+				target->preTick(evt);
+			}
+		}
+	}
 
-	// Actor tick
-	for (Ogre::list<Actor*>::iterator it = mAllActors.begin(); it != mAllActors.end(); it++)
+	// Actor parallel tick : independent, read-only work spread over all cores
 	{
-		ref = *it;
-		ref->tick(evt);
+		ProfileZone parallelZone("ParallelTick");
+		mParallelActors.clear();
+		for (size_t i = 0; i < mAwakeActors.size(); i++)
+		{
+			Actor* target = mAllActors.get(mAwakeActors[i]);
+			if (target && target->hasParallelTick())
+			{
+				mParallelActors.push_back(target);
+			}
+		}
+		if (mParallelActors.size() > 0)
+		{
+			ParallelTickData data;
+			data.actors = &mParallelActors[0];
+			data.evt = &evt;
+			mJobs->parallelFor(mParallelActors.size(), PARALLEL_GRAIN, &parallelTickJob, &data);
+		}
 	}
 
-	// Actor garbage collector
-	Actor* previousItem = NULL;
-	for (Ogre::list<Actor*>::iterator it = mToRemoveActors.begin(); it != mToRemoveActors.end();it++)
+	// Actor tick : applies the parallel results in registry order
 	{
-		deleteActor(previousItem);
-		previousItem = *it;
+		ProfileZone tickZone("Tick");
+		for (size_t i = 0; i < mAwakeActors.size(); i++)
+		{
+			Actor* target = mAllActors.get(mAwakeActors[i]);
+			if (target && (target->getTickGroups() & Actor::TG_MAIN))
+			{
+				target->tick(evt);
+			}
+		}
 	}
-	mToRemoveActors.clear();
-	deleteActor(previousItem);
 
-	// Debug physics
-	mPhysDrawer->step();
-	
-	//const Ogre::RenderTarget::FrameStats& stats = mWindow->getStatistics();
-	//gameLog("FPS:" + Ogre::StringConverter::toString(stats.lastFPS));
+	// Actor garbage collector (deletions may unregister more actors)
+	{
+		ProfileZone gcZone("GC");
+		for (size_t i = 0; i < mToRemoveActors.size(); i++)
+		{
+			Actor* target = mAllActors.get(mToRemoveActors[i]);
+			if (target)
+			{
+				mAllActors.remove(mToRemoveActors[i]);
+				delete target;
+				bTickGroupsDirty = true;
+			}
+		}
+		mToRemoveActors.clear();
+	}
+
+	// Floating origin
+	updateOrigin();
+}
+
+
+void Game::updateOrigin()
+{
+	if (mOriginDistance <= 0 || !mPlayer)
+	{
+		return;
+	}
+
+	// Snap to a grid so that the origin only moves by whole cells
+	Vector3 player = mPlayer->getNode()->_getDerivedPosition();
+	if (Math::Abs(player.x) > mOriginDistance || Math::Abs(player.y) > mOriginDistance || Math::Abs(player.z) > mOriginDistance)
+	{
+		Vector3 shift(
+			mOriginDistance * Math::Floor(player.x / mOriginDistance + 0.5f),
+			mOriginDistance * Math::Floor(player.y / mOriginDistance + 0.5f),
+			mOriginDistance * Math::Floor(player.z / mOriginDistance + 0.5f));
+		rebaseOrigin(shift);
+	}
+}
+
+
+void Game::updateTickGroups()
+{
+	mTickActors.clear();
+	for (size_t i = 0; i < mAllActors.size(); i++)
+	{
+		Actor* target = mAllActors.at(i);
+		if (target->getTickGroups() != Actor::TG_NONE && !target->isStatic())
+		{
+			mTickActors.push_back(target->getHandle());
+		}
+	}
+	bTickGroupsDirty = false;
+}
+
+
+void Game::interpolate(Real alpha)
+{
+	for (size_t i = 0; i < mMovingBodies.size(); i++)
+	{
+		mMovingBodies[i]->interpolate(alpha);
+	}
+}
+
+
+Real Game::getTickStep()
+{
+	return mTickStep;
 }
 	
 
-void Game::registerActor(Actor* ref)
+ActorHandle Game::registerActor(Actor* ref)
 {
-	mAllActors.push_back(ref);
+	bTickGroupsDirty = true;
+	return mAllActors.add(ref);
 }
 	
 
 void Game::unregisterActor(Actor* ref)
 {
-	mToRemoveActors.push_back(ref);
+	mToRemoveActors.push_back(ref->getHandle());
 }
 
+
 void Game::deleteActor(Actor* target)
 {
-	if(target != NULL) {
-		mAllActors.remove(target);
+	if (target != NULL)
+	{
+		mAllActors.remove(target->getHandle());
 		delete target;
+		bTickGroupsDirty = true;
+	}
+}
+
+
+Actor* Game::getActor(ActorHandle handle)
+{
+	return mAllActors.get(handle);
+}
+
+
+void Game::refreshTickGroups()
+{
+	bTickGroupsDirty = true;
+}
+
+
+size_t Game::getActorCount()
+{
+	return mAllActors.size();
+}
+
+
+size_t Game::getTickingActorCount()
+{
+	return mTickActors.size();
+}
+
+
+size_t Game::getAwakeActorCount()
+{
+	return mAwakeActors.size();
+}
+
+
+WorldVector Game::getWorldOrigin()
+{
+	return mWorldOrigin;
+}
+
+
+void Game::rebaseOrigin(Vector3 shift)
+{
+	ProfileZone zone("Rebase");
+	mWorldOrigin = mWorldOrigin + WorldVector(shift);
+
+	// Rigid bodies, including sleeping ones, and their broadphase bounds
+	if (mPhysWorld)
+	{
+		btVector3 offset(-shift.x, -shift.y, -shift.z);
+		btCollisionObjectArray& objects = mPhysWorld->getCollisionObjectArray();
+		for (int i = 0; i < objects.size(); i++)
+		{
+			objects[i]->getWorldTransform().getOrigin() += offset;
+			objects[i]->getInterpolationWorldTransform().getOrigin() += offset;
+			mPhysWorld->updateSingleAabb(objects[i]);
+		}
+		mProjectiles->rebase(-shift);
+	}
+
+	// Actor nodes and motion states
+	for (size_t i = 0; i < mAllActors.size(); i++)
+	{
+		mAllActors.at(i)->rebase(-shift);
+	}
+	gameLog("Game::rebaseOrigin : origin at " + StringConverter::toString((Real)mWorldOrigin.x) + " "
+		+ StringConverter::toString((Real)mWorldOrigin.y) + " "
+		+ StringConverter::toString((Real)mWorldOrigin.z));
+}
+
+
+ProjectileManager* Game::getProjectiles()
+{
+	return mProjectiles;
+}
+
+
+JobSystem* Game::getJobs()
+{
+	return mJobs;
+}
+
+
+TemplateRegistry* Game::getTemplates()
+{
+	return mTemplates;
+}
+
+
+MaterialParamBuffer* Game::getMaterialParams()
+{
+	return mMaterialParams;
+}
+
+
+void Game::saveWorld(String name)
+{
+	Ogre::Timer timer;
+	SaveArchive* archive = createSaveArchive();
+	bool bCompress = mConfig->FirstChildElement("save")->FirstChildElement("compress")->BoolAttribute("value");
+
+	// Snapshot everything in memory, the file is written by the saver thread
+	for (size_t i = 0; i < mAllActors.size(); i++)
+	{
+		mAllActors.at(i)->saveTo(archive);
+	}
+	gameLog("Game::saveWorld : " + StringConverter::toString(archive->getObjectCount()) + " actors snapshot in "
+		+ StringConverter::toString(timer.getMicroseconds()) + "us");
+	mSaver->submit(archive, getSavePath(name), bCompress, this);
+}
+
+
+void Game::loadWorld(String name)
+{
+	mSaver->flush();
+	Ogre::Timer timer;
+	SaveArchive* archive = createSaveArchive();
+	if (archive->readFile(getSavePath(name)))
+	{
+		for (size_t i = 0; i < mAllActors.size(); i++)
+		{
+			mAllActors.at(i)->loadFrom(archive);
+		}
+		gameLog("Game::loadWorld : " + StringConverter::toString(archive->getObjectCount()) + " actors in "
+			+ StringConverter::toString(timer.getMilliseconds()) + "ms");
 	}
+	else
+	{
+		gameLog("Game::loadWorld : failed to read " + getSavePath(name));
+	}
+	delete archive;
 }
 
+
 Ogre::SceneNode* Game::createGameNode(String name)
 {
 	return mScene->getRootSceneNode()->createChildSceneNode(name);
@@ -145,13 +600,39 @@ void Game::deleteGameNode(Ogre::SceneNode* node)
 
 Ogre::Entity* Game::createGameEntity(String name, String file)
 {
+	if (bHeadless)
+	{
+		return NULL;
+	}
 	return mScene->createEntity(name, file);
 }
 
 
 void Game::deleteGameEntity(Ogre::Entity* entity)
 {
-	mScene->destroyEntity(entity);
+	if (entity)
+	{
+		mScene->destroyEntity(entity);
+	}
+}
+
+
+Ogre::InstancedEntity* Game::createGameInstance(String file, String material, bool bCastShadows)
+{
+	if (!mInstances)
+	{
+		return NULL;
+	}
+	return mInstances->create(file, material, bCastShadows);
+}
+
+
+void Game::deleteGameInstance(Ogre::InstancedEntity* instance)
+{
+	if (mInstances)
+	{
+		mInstances->destroy(instance);
+	}
 }
 
 
@@ -167,6 +648,52 @@ void Game::unregisterRigidBody(btRigidBody* body)
 }
 
 
+void Game::registerMovingBody(ActorMotionState* state)
+{
+	mMovingBodies.push_back(state);
+}
+
+
+void Game::unregisterMovingBody(ActorMotionState* state)
+{
+	for (size_t i = 0; i < mMovingBodies.size(); i++)
+	{
+		if (mMovingBodies[i] == state)
+		{
+			mMovingBodies[i] = mMovingBodies.back();
+			mMovingBodies.pop_back();
+			break;
+		}
+	}
+}
+
+
+size_t Game::getMovingBodyCount()
+{
+	return mMovingBodies.size();
+}
+
+
+void Game::registerForces(ForceAccumulator* forces)
+{
+	mForceAccumulators.push_back(forces);
+}
+
+
+void Game::unregisterForces(ForceAccumulator* forces)
+{
+	for (size_t i = 0; i < mForceAccumulators.size(); i++)
+	{
+		if (mForceAccumulators[i] == forces)
+		{
+			mForceAccumulators[i] = mForceAccumulators.back();
+			mForceAccumulators.pop_back();
+			break;
+		}
+	}
+}
+
+
 void Game::quit()
 {
 	bRunning = false;
@@ -200,6 +727,7 @@ bool Game::frameRenderingQueued(const Ogre::FrameEvent& evt)
 bool Game::frameEnded(const Ogre::FrameEvent& evt)
 {
 	mIOManager->postrender(evt);
+	Profiler::get().endFrame();
 	return bRunning;
 }
 
@@ -216,6 +744,10 @@ void Game::gameLog(String text)
 
 void Game::setDebugMode(int newStatus)
 {
+	if (bHeadless)
+	{
+		return;
+	}
 	mPhysDrawer->setDebugMode(0);
 	switch (newStatus)
 	{
@@ -269,9 +801,20 @@ void Game::dumpAllNodes()
 bool Game::setup()
 {
 	setupResources();
-	setupSystem("OpenGL");
-	setupPhysics(Vector3(0, 0, 0), false);
-	setupRender(true);
+	setupTemplates();
+	setupSimulation();
+	if (bHeadless)
+	{
+		setupHeadless();
+		setupPhysics(Vector3(0, 0, 0), false);
+		setupPlayer();
+	}
+	else
+	{
+		setupSystem("OpenGL");
+		setupPhysics(Vector3(0, 0, 0), false);
+		setupRender(true);
+	}
 	construct();
 	return true;
 }
@@ -355,11 +898,112 @@ bool Game::setupSystem(const String desiredRenderer)
 
 	// Window
 	mWindow = mRoot->initialise(true, "Soyouz");
-	mScene = mRoot->createSceneManager(Ogre::ST_GENERIC, "GameScene");
+	setupScene();
     return true;
 }
 
 
+void Game::setupHeadless()
+{
+	// No render system : meshes are kept in system memory for collisions only
+	mBufferManager = new Ogre::DefaultHardwareBufferManager();
+	setupScene();
+	gameLog("Game::setupHeadless : running without render system");
+}
+
+
+void Game::setupScene()
+{
+	tinyxml2::XMLElement* sceneConf = mConfig->FirstChildElement("scene");
+	assert(sceneConf != NULL);
+
+	// Loose octree : objects go to the deepest cell that holds them with twice its size
+	mScene = NULL;
+	if (String(sceneConf->FirstChildElement("manager")->Attribute("value")) == "octree")
+	{
+		try
+		{
+			mScene = mRoot->createSceneManager("OctreeSceneManager", "GameScene");
+		}
+		catch (Ogre::Exception& e)
+		{
+			gameLog("Game::setupScene : octree scene manager unavailable, using the generic one");
+		}
+	}
+
+	// Octree bounds and depth from the smallest cell size
+	if (mScene)
+	{
+		Real worldSize = sceneConf->FirstChildElement("worldSize")->FloatAttribute("value");
+		Real cellSize = sceneConf->FirstChildElement("cellSize")->FloatAttribute("value");
+		Ogre::AxisAlignedBox bounds(-worldSize, -worldSize, -worldSize, worldSize, worldSize, worldSize);
+		int depth = 1;
+		while (depth < SCENE_MAX_DEPTH && (2 * worldSize) / (1 << depth) > cellSize)
+		{
+			depth++;
+		}
+		mScene->setOption("Size", &bounds);
+		mScene->setOption("Depth", &depth);
+		gameLog("Game::setupScene : octree of " + StringConverter::toString(2 * worldSize) + " units, "
+			+ StringConverter::toString(depth) + " levels, "
+			+ StringConverter::toString((2 * worldSize) / (1 << depth)) + " units cells");
+	}
+	else
+	{
+		mScene = mRoot->createSceneManager(Ogre::ST_GENERIC, "GameScene");
+	}
+
+	// Visibility query timings
+	mCullingProfiler = new CullingProfiler();
+	mScene->addListener(mCullingProfiler);
+}
+
+
+void Game::runHeadless()
+{
+	Ogre::Timer timer;
+	Ogre::FrameEvent evt;
+	unsigned long ticks = 0;
+	evt.timeSinceLastEvent = mTickStep;
+	evt.timeSinceLastFrame = mTickStep;
+
+	// Run as fast as possible, exactly one simulation step per tick
+	timer.reset();
+	while (bRunning)
+	{
+		tick(evt);
+		Profiler::get().endFrame();
+		ticks++;
+		if (mHeadlessDuration > 0 && ticks * mTickStep >= mHeadlessDuration)
+		{
+			break;
+		}
+	}
+
+	// Throughput report
+	unsigned long elapsed = timer.getMilliseconds();
+	Real simulated = ticks * mTickStep;
+	Real rate = (elapsed > 0) ? (1000.0f * ticks / elapsed) : 0;
+	gameLog("Game::runHeadless : simulated " + StringConverter::toString(simulated) + "s in "
+		+ StringConverter::toString(elapsed) + "ms, "
+		+ StringConverter::toString(ticks) + " ticks ("
+		+ StringConverter::toString(rate) + " ticks/s)");
+	if (mPhysWorld)
+	{
+		unsigned long fired = mProjectiles->getSpawnCount();
+		unsigned long hits = mProjectiles->getHitCount();
+		gameLog("Game::runHeadless : " + StringConverter::toString(mPhysMaxPairs) + " broadphase pairs at most, "
+			+ StringConverter::toString(fired) + " projectiles fired, "
+			+ StringConverter::toString(hits) + " hits, "
+			+ StringConverter::toString(fired - hits - mProjectiles->getCount()) + " expired");
+	}
+	gameLog("Game::runHeadless : " + StringConverter::toString(getAwakeActorCount()) + " awake / "
+		+ StringConverter::toString(getTickingActorCount()) + " ticking / "
+		+ StringConverter::toString(getActorCount()) + " actors");
+	gameLog("Game::runHeadless : min / avg / p99 per tick\n" + Profiler::get().getReport());
+}
+
+
 void Game::setupRender(bool bShowPostProcess)
 {
 	// Render resources
@@ -386,27 +1030,129 @@ void Game::setupRender(bool bShowPostProcess)
 	// Deferred rendering setup
 	mRenderer = new Renderer(mWindow->getViewport(0), mScene, mConfig);
 	mRenderer->setMode(Renderer::DSM_SHOWLIT);
+
+	// Hardware instancing of shared meshes
+	mInstances = new InstanceCache(mScene, mConfig);
 }
 
 
 void Game::setupPhysics(Vector3 gravity, bool bDrawDebug)
 {
-	mPhysCollisionConfiguration = new btDefaultCollisionConfiguration();
-	mPhysDispatcher = new btCollisionDispatcher(mPhysCollisionConfiguration);
-	mPhysBroadphase = new btDbvtBroadphase();
-	mPhysSequentialImpulseConstraintSolver = new btSequentialImpulseConstraintSolver;
+	tinyxml2::XMLElement* physConf = mConfig->FirstChildElement("physics");
+	assert(physConf != NULL);
+	if (mPhysBackend == "")
+	{
+		mPhysBackend = physConf->FirstChildElement("backend")->Attribute("value");
+	}
 
-	mPhysWorld = new btDiscreteDynamicsWorld(
-		mPhysDispatcher,
-		mPhysBroadphase,
-		mPhysSequentialImpulseConstraintSolver,
-		mPhysCollisionConfiguration);
+	// Multithreaded world, or the single-threaded one as a fallback
+	if (mPhysBackend == "multithreaded" && !setupPhysicsMt())
+	{
+		gameLog("Game::setupPhysics : Bullet was built without BT_THREADSAFE, using the sequential backend");
+		mPhysBackend = "sequential";
+	}
+	if (mPhysBackend != "multithreaded")
+	{
+		btDefaultCollisionConstructionInfo info;
+		info.m_defaultMaxPersistentManifoldPoolSize = PHYSICS_POOL_SIZE;
+		info.m_defaultMaxCollisionAlgorithmPoolSize = PHYSICS_POOL_SIZE;
+		mPhysCollisionConfiguration = new btDefaultCollisionConfiguration(info);
+		mPhysDispatcher = new btCollisionDispatcher(mPhysCollisionConfiguration);
+		mPhysBroadphase = createBroadphase();
+		mPhysSolver = new btSequentialImpulseConstraintSolver;
+
+		mPhysWorld = new btDiscreteDynamicsWorld(
+			mPhysDispatcher,
+			mPhysBroadphase,
+			mPhysSolver,
+			mPhysCollisionConfiguration);
+	}
+	gameLog("Game::setupPhysics : " + mPhysBackend + " backend");
 
 	mPhysWorld->setGravity(btVector3(gravity[0], gravity[1], gravity[2]));
 
 	mPhysDrawer = new DebugDrawer(mScene, mScene->getRootSceneNode(), mPhysWorld);
 	mPhysDrawer->setDebugMode(bDrawDebug ? 1:0);
 	mPhysWorld->setDebugDrawer(mPhysDrawer);
+
+	// Projectile pool
+	tinyxml2::XMLElement* simConf = mConfig->FirstChildElement("simulation");
+	assert(simConf != NULL);
+	size_t maxProjectiles = simConf->FirstChildElement("maxProjectiles")->IntAttribute("value");
+	mProjectiles = new ProjectileManager(mScene, mPhysWorld, maxProjectiles, !bHeadless);
+
+	// Stress scene
+	if (mPhysBenchmarkBodies > 0)
+	{
+		mPhysBenchmark = new PhysicsBenchmark(mPhysWorld, mPhysBenchmarkBodies);
+		gameLog("Game::setupPhysics : benchmark with " + StringConverter::toString(mPhysBenchmarkBodies) + " rigid bodies");
+	}
+}
+
+
+btBroadphaseInterface* Game::createBroadphase()
+{
+	tinyxml2::XMLElement* physConf = mConfig->FirstChildElement("physics");
+	assert(physConf != NULL);
+
+	// Sweep and prune over a bounded arena, kept around the player by the floating origin
+	if (String(physConf->FirstChildElement("broadphase")->Attribute("value")) == "sweep")
+	{
+		Real arenaSize = physConf->FirstChildElement("arenaSize")->FloatAttribute("value");
+		int maxBodies = physConf->FirstChildElement("arenaBodies")->IntAttribute("value");
+		gameLog("Game::createBroadphase : sweep and prune over " + StringConverter::toString(2 * arenaSize) + " units");
+		return new bt32BitAxisSweep3(
+			btVector3(-arenaSize, -arenaSize, -arenaSize),
+			btVector3(arenaSize, arenaSize, arenaSize),
+			maxBodies);
+	}
+
+	// Dynamic AABB trees, unbounded
+	gameLog("Game::createBroadphase : dynamic AABB tree");
+	return new btDbvtBroadphase();
+}
+
+
+bool Game::setupPhysicsMt()
+{
+#if BT_THREADSAFE
+	tinyxml2::XMLElement* physConf = mConfig->FirstChildElement("physics");
+	assert(physConf != NULL);
+
+	// Bullet tasks run on the engine workers
+	mPhysScheduler = new PhysicsScheduler(mJobs);
+	btSetTaskScheduler(mPhysScheduler);
+
+	btDefaultCollisionConstructionInfo info;
+	info.m_defaultMaxPersistentManifoldPoolSize = PHYSICS_POOL_SIZE;
+	info.m_defaultMaxCollisionAlgorithmPoolSize = PHYSICS_POOL_SIZE;
+	mPhysCollisionConfiguration = new btDefaultCollisionConfiguration(info);
+	mPhysDispatcher = new btCollisionDispatcherMt(mPhysCollisionConfiguration, PHYSICS_GRAIN);
+	mPhysBroadphase = createBroadphase();
+
+	// Small islands are solved in parallel by the pool, large ones by the parallel solver
+	int solverCount = physConf->FirstChildElement("solverPool")->IntAttribute("value");
+	if (solverCount <= 0)
+	{
+		solverCount = mPhysScheduler->getNumThreads();
+	}
+	btConstraintSolverPoolMt* solverPool = new btConstraintSolverPoolMt(solverCount);
+	btSequentialImpulseConstraintSolverMt* solverMt = new btSequentialImpulseConstraintSolverMt();
+	mPhysSolver = solverPool;
+	mPhysSolverMt = solverMt;
+
+	mPhysWorld = new btDiscreteDynamicsWorldMt(
+		mPhysDispatcher,
+		mPhysBroadphase,
+		solverPool,
+		solverMt,
+		mPhysCollisionConfiguration);
+
+	gameLog("Game::setupPhysicsMt : " + StringConverter::toString(solverCount) + " pooled solvers");
+	return true;
+#else
+	return false;
+#endif
 }
 
 
@@ -416,6 +1162,72 @@ void Game::setupPlayer()
 }
 
 
+void Game::setupTemplates()
+{
+	Ogre::Timer timer;
+	mTemplates->load();
+	gameLog("Game::setupTemplates : parsed in " + StringConverter::toString(timer.getMilliseconds()) + "ms");
+}
+
+
+void Game::saveCompleted(String path, bool bSuccess, unsigned long duration)
+{
+	gameLog("Game::saveCompleted : " + path + (bSuccess ? " written in " : " failed after ")
+		+ StringConverter::toString(duration) + "ms");
+}
+
+
+SaveArchive* Game::createSaveArchive()
+{
+	tinyxml2::XMLElement* saveConf = mConfig->FirstChildElement("save");
+	assert(saveConf != NULL);
+	if (String(saveConf->FirstChildElement("format")->Attribute("value")) == "binary")
+	{
+		return new BinarySaveArchive();
+	}
+	else
+	{
+		return new XmlSaveArchive("world");
+	}
+}
+
+
+String Game::getSavePath(String name)
+{
+	tinyxml2::XMLElement* saveConf = mConfig->FirstChildElement("save");
+	assert(saveConf != NULL);
+	bool bBinary = (String(saveConf->FirstChildElement("format")->Attribute("value")) == "binary");
+	return SAVE_DIR + name + (bBinary ? ".sav" : ".xml");
+}
+
+
+void Game::setupSimulation()
+{
+	tinyxml2::XMLElement* simConf = mConfig->FirstChildElement("simulation");
+	assert(simConf != NULL);
+
+	// Step rate and catch-up policy
+	mTickStep = 1.0f / simConf->FirstChildElement("tickRate")->FloatAttribute("value");
+	mMaxCatchUpSteps = simConf->FirstChildElement("maxCatchUpSteps")->IntAttribute("value");
+	mCatchUpBudget = simConf->FirstChildElement("catchUpBudget")->FloatAttribute("value");
+	bDropLateTicks = (String(simConf->FirstChildElement("catchUpPolicy")->Attribute("value")) == "drop");
+	mTickAccumulator = 0;
+
+	// Floating origin distance
+	mOriginDistance = simConf->FirstChildElement("originDistance")->FloatAttribute("value");
+
+	// Worker threads for the parallel tick
+	mJobs = new JobSystem(simConf->FirstChildElement("workerThreads")->IntAttribute("value"));
+	gameLog("Game::setupSimulation : " + StringConverter::toString(mJobs->getThreadCount()) + " worker threads");
+
+	// Autosave period
+	tinyxml2::XMLElement* saveConf = mConfig->FirstChildElement("save");
+	assert(saveConf != NULL);
+	mAutosaveDelay = saveConf->FirstChildElement("autosave")->FloatAttribute("value");
+	mAutosaveTimer = 0;
+}
+
+
 void Game::dumpNodes(std::stringstream &ss, Ogre::Node* n, int level)
 {
 	for (int i = 0; i < level; i++)
@@ -10,20 +10,33 @@
 #define __GAME_H_
 
 #include "Engine/Rendering/renderer.hpp"
+#include "Engine/Rendering/instancing.hpp"
+#include "Engine/Rendering/materialparams.hpp"
 #include "Engine/bulletphysics.hpp"
 #include "Engine/iomanager.hpp"
+#include "Engine/actorregistry.hpp"
+#include "Engine/projectiles.hpp"
+#include "Engine/templateregistry.hpp"
+#include "Engine/asyncsaver.hpp"
+#include "Engine/jobsystem.hpp"
+#include "Engine/forceaccumulator.hpp"
 #include "tinyxml2.hpp"
 
 class Actor;
 class Player;
+class SaveArchive;
 class PointLight;
+class PhysicsScheduler;
+class PhysicsBenchmark;
+class ActorMotionState;
+class CullingProfiler;
 
 
 /*----------------------------------------------
 	Game class definition
 ----------------------------------------------*/
 
-class Game : public Ogre::FrameListener
+class Game : public Ogre::FrameListener, public SaveListener
 {
 
 public:
@@ -44,19 +57,51 @@ public:
 	virtual void run();
 	
 	/**
-	 * @brief Main tick event
+	 * @brief Run the simulation without any window, renderer or input
+	 * @param bNewHeadless		New state
+	 * @param duration			Simulated time in seconds, 0 to run until quit()
+	 **/
+	void setHeadless(bool bNewHeadless, Real duration = 0);
+	
+	/**
+	 * @brief Are we running without rendering ?
+	 * @return true if headless
+	 **/
+	bool isHeadless();
+	
+	/**
+	 * @brief Override the physics backend from the config file
+	 * @param backend			"sequential" or "multithreaded"
+	 **/
+	void setPhysicsBackend(String backend);
+	
+	/**
+	 * @brief Add a cloud of rigid bodies to the world to measure the physics step
+	 * @param bodyCount			Number of bodies, 0 to disable
+	 **/
+	void setPhysicsBenchmark(int bodyCount);
+	
+	/**
+	 * @brief Main tick event, runs as many fixed simulation steps as needed
 	 * @param evt				Frame event
 	 **/
 	virtual void tick(const Ogre::FrameEvent& evt);
 	
+	/**
+	 * @brief Get the fixed simulation time step
+	 * @return the step duration in seconds
+	 **/
+	Real getTickStep();
+	
 	/**
 	 * @brief Register an actor to the world
 	 * @param ref				Actor reference
+	 * @return the actor handle
 	 **/
-	void registerActor(Actor* ref);
+	ActorHandle registerActor(Actor* ref);
 	
 	/**
-	 * @brief Unregister an actor to the world
+	 * @brief Unregister an actor to the world, it will be deleted after the tick
 	 * @param ref				Actor reference
 	 **/
 	void unregisterActor(Actor* ref);
@@ -66,6 +111,92 @@ public:
 	 * @param target			Actor reference
 	 **/
 	void deleteActor(Actor* target);
+	
+	/**
+	 * @brief Resolve an actor handle
+	 * @param handle			Actor handle
+	 * @return the actor, or NULL if it was deleted
+	 **/
+	Actor* getActor(ActorHandle handle);
+	
+	/**
+	 * @brief Rebuild the tick lists before the next step, after tick groups or static flags changed
+	 **/
+	void refreshTickGroups();
+	
+	/**
+	 * @brief Get the number of live actors
+	 * @return the actor count
+	 **/
+	size_t getActorCount();
+	
+	/**
+	 * @brief Get the number of actors in a tick group and not static
+	 * @return the actor count
+	 **/
+	size_t getTickingActorCount();
+	
+	/**
+	 * @brief Get the number of actors ticked during the last step
+	 * @return the actor count
+	 **/
+	size_t getAwakeActorCount();
+	
+	/**
+	 * @brief Get the absolute position of the local origin
+	 * @return the double-precision origin
+	 **/
+	WorldVector getWorldOrigin();
+	
+	/**
+	 * @brief Move the local origin : all actors, bodies and projectiles are moved back
+	 * @param shift				New origin, relative to the current one
+	 **/
+	void rebaseOrigin(Vector3 shift);
+	
+	/**
+	 * @brief Get the projectile pool
+	 * @return the projectile manager
+	 **/
+	ProjectileManager* getProjectiles();
+	
+	/**
+	 * @brief Get the parsed content templates
+	 * @return the template registry
+	 **/
+	TemplateRegistry* getTemplates();
+	
+	/**
+	 * @brief Get the custom material parameters of all meshes
+	 * @return the parameter buffer
+	 **/
+	MaterialParamBuffer* getMaterialParams();
+	
+	/**
+	 * @brief Get the worker threads
+	 * @return the job system
+	 **/
+	JobSystem* getJobs();
+	
+	/**
+	 * @brief Snapshot all savable actors, then write them to a single file in the background
+	 * @param name				Save name, without extension
+	 **/
+	void saveWorld(String name = "world");
+	
+	/**
+	 * @brief Restore all savable actors from a world save, after pending saves are written
+	 * @param name				Save name, without extension
+	 **/
+	void loadWorld(String name = "world");
+	
+	/**
+	 * @brief Background save event
+	 * @param path				Saved file
+	 * @param bSuccess			false if the file could not be written
+	 * @param duration			Write time in ms
+	 **/
+	virtual void saveCompleted(String path, bool bSuccess, unsigned long duration);
 
 	/**
 	 * @brief Run the level (blocking)
@@ -94,6 +225,21 @@ public:
 	 **/
 	void deleteGameEntity(Ogre::Entity* entity);
 	
+	/**
+	 * @brief Create an instance of a mesh, drawn in a batch shared with the same mesh and material
+	 * @param file				File name
+	 * @param material			Material name
+	 * @param bCastShadows		Should cast shadows
+	 * @return the instance, or NULL to use an entity instead
+	 **/
+	Ogre::InstancedEntity* createGameInstance(String file, String material, bool bCastShadows);
+	
+	/**
+	 * @brief Remove an instance
+	 * @param instance			Instance reference
+	 **/
+	void deleteGameInstance(Ogre::InstancedEntity* instance);
+	
 	/**
 	 * @brief Register a rigid body to the scene
 	 * @param body				Rigid body
@@ -106,6 +252,36 @@ public:
 	 **/
 	void unregisterRigidBody(btRigidBody* body);
 	
+	/**
+	 * @brief Add a body moved by the last physics step to the node updates
+	 * @param state				Body motion state
+	 **/
+	void registerMovingBody(ActorMotionState* state);
+	
+	/**
+	 * @brief Remove a body from the node updates
+	 * @param state				Body motion state
+	 **/
+	void unregisterMovingBody(ActorMotionState* state);
+	
+	/**
+	 * @brief Get the number of bodies moved by the last physics step
+	 * @return the body count
+	 **/
+	size_t getMovingBodyCount();
+	
+	/**
+	 * @brief Register a force accumulator, flushed before each physics step
+	 * @param forces			Force accumulator
+	 **/
+	void registerForces(ForceAccumulator* forces);
+	
+	/**
+	 * @brief Unregister a force accumulator
+	 * @param forces			Force accumulator
+	 **/
+	void unregisterForces(ForceAccumulator* forces);
+	
 	/**
 	 * @brief Quit the game
 	 **/
@@ -182,11 +358,44 @@ protected:
 	 **/
 	virtual void setupResources();
 	
+	/**
+	 * @brief Parse all content templates, override to add parsers then call this
+	 **/
+	virtual void setupTemplates();
+	
+	/**
+	 * @brief Create an empty archive for the configured save format
+	 * @return the archive
+	 **/
+	SaveArchive* createSaveArchive();
+	
+	/**
+	 * @brief Get the world save path for the configured save format
+	 * @param name				Save name, without extension
+	 * @return the file path
+	 **/
+	String getSavePath(String name);
+	
 	/**
 	 * @brief Setup the render sytsem
 	 * @param desiredRenderer	Render system to use
 	 **/
 	virtual bool setupSystem(const String desiredRenderer);
+	
+	/**
+	 * @brief Create the scene manager from the config file
+	 **/
+	virtual void setupScene();
+	
+	/**
+	 * @brief Setup the scene without render system (headless mode)
+	 **/
+	virtual void setupHeadless();
+	
+	/**
+	 * @brief Headless fixed-step main loop (blocking)
+	 **/
+	virtual void runHeadless();
 
 	/**
 	 * @brief Setup rendering methods
@@ -198,6 +407,33 @@ protected:
 	 * @brief Setup the player
 	 **/
 	virtual void setupPlayer();
+	
+	/**
+	 * @brief Setup the fixed-step game loop from the config file
+	 **/
+	virtual void setupSimulation();
+	
+	/**
+	 * @brief Run one fixed simulation step : physics, actors, garbage collection
+	 * @param evt				Step event
+	 **/
+	virtual void fixedTick(const Ogre::FrameEvent& evt);
+	
+	/**
+	 * @brief Rebase around the player when it gets too far from the origin
+	 **/
+	void updateOrigin();
+	
+	/**
+	 * @brief Rebuild the list of ticking actors, in registry order
+	 **/
+	void updateTickGroups();
+	
+	/**
+	 * @brief Move the nodes of the moving bodies between two simulation steps
+	 * @param alpha				Fraction of a step since the last one (0 - 1)
+	 **/
+	virtual void interpolate(Real alpha);
 
 	/**
 	 * @brief Setup the physics world
@@ -206,6 +442,18 @@ protected:
 	 **/
 	virtual void setupPhysics(Vector3 gravity, bool bDrawDebug = false);
 	
+	/**
+	 * @brief Create the broadphase from the config file
+	 * @return the broadphase
+	 **/
+	btBroadphaseInterface* createBroadphase();
+	
+	/**
+	 * @brief Create the multithreaded physics world on the job system
+	 * @return false if Bullet was built without BT_THREADSAFE
+	 **/
+	bool setupPhysicsMt();
+	
 	/**
 	 * @brief Dump a node to a string stream
 	 * @param ss				Output stream
@@ -221,30 +469,68 @@ protected:
 
 	// Is it running ?
 	bool bRunning;
+	bool bHeadless;
+	Real mHeadlessDuration;
+
+	// Fixed-step loop
+	Real mTickStep;
+	Real mTickAccumulator;
+	Real mCatchUpBudget;
+	int mMaxCatchUpSteps;
+	bool bDropLateTicks;
+	bool bTickGroupsDirty;
+	Ogre::Timer mTickTimer;
+	
+	// Floating origin
+	WorldVector mWorldOrigin;
+	Real mOriginDistance;
+	
+	// Save data
+	AsyncSaver* mSaver;
+	Real mAutosaveDelay;
+	Real mAutosaveTimer;
 	
 	// OGRE data
 	Ogre::Root* mRoot;
 	Ogre::SceneManager* mScene;
 	Ogre::RenderWindow* mWindow;
 	Ogre::OverlaySystem* mOverlaySystem;
+	Ogre::DefaultHardwareBufferManager* mBufferManager;
+	CullingProfiler* mCullingProfiler;
 
 	// Bullet data
+	String mPhysBackend;
+	int mPhysBenchmarkBodies;
+	int mPhysMaxPairs;
 	DebugDrawer* mPhysDrawer;
 	btDiscreteDynamicsWorld* mPhysWorld;
 	btBroadphaseInterface* mPhysBroadphase;
 	btCollisionDispatcher* mPhysDispatcher;
 	btDefaultCollisionConfiguration* mPhysCollisionConfiguration;
-	btSequentialImpulseConstraintSolver* mPhysSequentialImpulseConstraintSolver;
+	btConstraintSolver* mPhysSolver;
+	btConstraintSolver* mPhysSolverMt;
+	PhysicsScheduler* mPhysScheduler;
+	PhysicsBenchmark* mPhysBenchmark;
 
 	// Custom data
 	Renderer* mRenderer;
+	InstanceCache* mInstances;
+	MaterialParamBuffer* mMaterialParams;
 	Player* mPlayer;
+	ProjectileManager* mProjectiles;
+	TemplateRegistry* mTemplates;
+	JobSystem* mJobs;
 	IOManager* mIOManager;
 	tinyxml2::XMLDocument* mConfigFile;
 	tinyxml2::XMLElement* mConfig;
 
-	Ogre::list<Actor*>::type mAllActors;
-	Ogre::list<Actor*>::type mToRemoveActors;
+	ActorRegistry mAllActors;
+	Ogre::vector<ActorHandle>::type mToRemoveActors;
+	Ogre::vector<ActorHandle>::type mTickActors;
+	Ogre::vector<ActorHandle>::type mAwakeActors;
+	Ogre::vector<Actor*>::type mParallelActors;
+	Ogre::vector<ForceAccumulator*>::type mForceAccumulators;
+	Ogre::vector<ActorMotionState*>::type mMovingBodies;
 
 #ifdef OGRE_STATIC_LIB
 	StaticPluginLoader mStaticPluginLoader;
@@ -21,4 +21,24 @@ typedef Ogre::Math Math;
 typedef Ogre::StringConverter StringConverter;
 typedef Ogre::StringUtil StringUtil;
 
+
+/*----------------------------------------------
+	Double-precision world position
+----------------------------------------------*/
+
+struct WorldVector
+{
+	WorldVector() : x(0), y(0), z(0) {}
+	WorldVector(double nx, double ny, double nz) : x(nx), y(ny), z(nz) {}
+	WorldVector(const Vector3& v) : x(v.x), y(v.y), z(v.z) {}
+
+	WorldVector operator+(const WorldVector& v) const { return WorldVector(x + v.x, y + v.y, z + v.z); }
+	WorldVector operator-(const WorldVector& v) const { return WorldVector(x - v.x, y - v.y, z - v.z); }
+	Vector3 toVector3() const { return Vector3((Real)x, (Real)y, (Real)z); }
+
+	double x;
+	double y;
+	double z;
+};
+
 #endif /* __GAME_TYPES_H_ */
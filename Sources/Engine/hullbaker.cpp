@@ -0,0 +1,151 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#include "Engine/hullbaker.hpp"
+#include "Engine/hullfile.hpp"
+
+
+/*----------------------------------------------
+	Definitions
+----------------------------------------------*/
+
+#define BAKE_GROUP "Bake"
+
+
+/**
+ * @brief Get the positions of a submesh, only the ones it indexes when the vertices are shared
+ * @param mesh			OGRE mesh data
+ * @param submesh		Submesh index
+ * @param vertices		Output vertices
+ **/
+static void getSubMeshVertices(Ogre::Mesh* mesh, unsigned short submesh, Ogre::vector<Vector3>::type& vertices)
+{
+	Ogre::SubMesh* sub = mesh->getSubMesh(submesh);
+	Ogre::VertexData* vertexData = sub->useSharedVertices ? mesh->sharedVertexData : sub->vertexData;
+	const Ogre::VertexElement* posElem = vertexData->vertexDeclaration->findElementBySemantic(Ogre::VES_POSITION);
+	Ogre::HardwareVertexBufferSharedPtr vbuf = vertexData->vertexBufferBinding->getBuffer(posElem->getSource());
+
+	// Shared vertices : mark the ones referenced by this submesh
+	Ogre::vector<bool>::type used(vertexData->vertexCount, !sub->useSharedVertices);
+	Ogre::IndexData* indexData = sub->indexData;
+	if (sub->useSharedVertices && indexData->indexCount > 0)
+	{
+		Ogre::HardwareIndexBufferSharedPtr ibuf = indexData->indexBuffer;
+		bool b32 = (ibuf->getType() == Ogre::HardwareIndexBuffer::IT_32BIT);
+		void* indices = ibuf->lock(Ogre::HardwareBuffer::HBL_READ_ONLY);
+		for (size_t j = indexData->indexStart; j < indexData->indexStart + indexData->indexCount; ++j)
+		{
+			size_t index = b32 ? static_cast<Ogre::uint32*>(indices)[j] : static_cast<Ogre::uint16*>(indices)[j];
+			if (index < used.size())
+			{
+				used[index] = true;
+			}
+		}
+		ibuf->unlock();
+	}
+
+	unsigned char* vertex = static_cast<unsigned char*>(vbuf->lock(Ogre::HardwareBuffer::HBL_READ_ONLY));
+	vertex += vertexData->vertexStart * vbuf->getVertexSize();
+	float* pReal;
+
+	vertices.clear();
+	for (size_t j = 0; j < vertexData->vertexCount; ++j, vertex += vbuf->getVertexSize())
+	{
+		if (used[j])
+		{
+			posElem->baseVertexPointerToElement(vertex, &pReal);
+			vertices.push_back(Vector3(pReal[0], pReal[1], pReal[2]));
+		}
+	}
+	vbuf->unlock();
+}
+
+
+/**
+ * @brief Build the simplified convex hull of a point cloud
+ * @param points		Input points
+ * @param hull			Output hull vertices
+ **/
+static void buildHull(const Ogre::vector<Vector3>::type& points, Ogre::vector<Vector3>::type& hull)
+{
+	btConvexHullShape shape;
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		shape.addPoint(btVector3(points[i].x, points[i].y, points[i].z), false);
+	}
+	shape.recalcLocalAabb();
+
+	btShapeHull reducer(&shape);
+	reducer.buildHull(shape.getMargin());
+	const btVector3* vertices = reducer.getVertexPointer();
+	for (int i = 0; i < reducer.numVertices(); i++)
+	{
+		hull.push_back(Vector3(vertices[i].x(), vertices[i].y(), vertices[i].z()));
+	}
+}
+
+
+/*----------------------------------------------
+	Baking
+----------------------------------------------*/
+
+int bakeHulls(String path)
+{
+	int failures = 0;
+
+	// Meshes go to system memory, no render system is needed
+	Ogre::Root* root = new Ogre::Root("", "", "Bake.log");
+	Ogre::DefaultHardwareBufferManager* buffers = new Ogre::DefaultHardwareBufferManager();
+	Ogre::ResourceGroupManager& resources = Ogre::ResourceGroupManager::getSingleton();
+	resources.addResourceLocation(path, "FileSystem", BAKE_GROUP, true);
+
+	// One hull per submesh : a compound decomposition following the modelled parts
+	Ogre::FileInfoListPtr meshes = resources.findResourceFileInfo(BAKE_GROUP, "*.mesh");
+	for (Ogre::FileInfoList::iterator it = meshes->begin(); it != meshes->end(); it++)
+	{
+		String base, ext, target;
+		Ogre::vector<Ogre::vector<Vector3>::type>::type hulls;
+		StringUtil::splitBaseFilename(it->filename, base, ext);
+		target = it->archive->getName() + "/" + base + ".hull";
+
+		try
+		{
+			Ogre::MeshPtr mesh = Ogre::MeshManager::getSingleton().load(it->basename, BAKE_GROUP);
+			for (unsigned short i = 0; i < mesh->getNumSubMeshes(); i++)
+			{
+				Ogre::vector<Vector3>::type points, hull;
+				getSubMeshVertices(mesh.get(), i, points);
+				if (points.size() >= 4)
+				{
+					buildHull(points, hull);
+					hulls.push_back(hull);
+				}
+			}
+			Ogre::MeshManager::getSingleton().remove(mesh->getHandle());
+		}
+		catch (Ogre::Exception& e)
+		{
+			Ogre::LogManager::getSingleton().logMessage("bakeHulls : " + e.getDescription());
+		}
+
+		// Report
+		if (hulls.size() > 0 && HullFile::write(target, hulls))
+		{
+			Ogre::LogManager::getSingleton().logMessage("bakeHulls : " + target + ", "
+				+ StringConverter::toString(hulls.size()) + " hulls");
+		}
+		else
+		{
+			Ogre::LogManager::getSingleton().logMessage("bakeHulls : failed on " + it->filename);
+			failures++;
+		}
+	}
+
+	delete root;
+	delete buffers;
+	return failures;
+}
@@ -0,0 +1,26 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#ifndef __HULL_BAKER_H_
+#define __HULL_BAKER_H_
+
+#include "Engine/Rendering/renderer.hpp"
+#include "Engine/gametypes.hpp"
+
+
+/*----------------------------------------------
+	Offline hull baking
+----------------------------------------------*/
+
+/**
+ * @brief Write a .hull file next to every mesh found in a folder, without any render system
+ * @param path			Content folder, searched recursively
+ * @return the number of meshes that failed
+ **/
+int bakeHulls(String path);
+
+#endif /* __HULL_BAKER_H_ */
@@ -0,0 +1,258 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#include "Engine/hullfile.hpp"
+
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+#	define WIN32_LEAN_AND_MEAN
+#	include "windows.h"
+#else
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
+
+
+/*----------------------------------------------
+	Definitions
+----------------------------------------------*/
+
+const Ogre::uint32 HULL_MAGIC = 0x4C4C5548; // "HULL"
+const Ogre::uint32 HULL_VERSION = 1;
+const size_t HULL_HEADER_SIZE = 4 * sizeof(Ogre::uint32);
+const size_t HULL_VERTEX_SIZE = 4 * sizeof(float);
+
+static size_t getVertexOffset(size_t hullCount)
+{
+	size_t offset = HULL_HEADER_SIZE + 2 * sizeof(Ogre::uint32) * hullCount;
+	return (offset + 15) & ~(size_t)15;
+}
+
+
+/*----------------------------------------------
+	Constructor & destructor
+----------------------------------------------*/
+
+HullFile::HullFile()
+{
+	mData = NULL;
+	mSize = 0;
+	mMapping = NULL;
+	mHullCount = 0;
+	mHulls = NULL;
+	mVertices = NULL;
+}
+
+
+HullFile::~HullFile()
+{
+	close();
+}
+
+
+/*----------------------------------------------
+	Public methods
+----------------------------------------------*/
+
+bool HullFile::open(String path)
+{
+	// Vertices are used in place as btVector3, double precision builds use the meshes instead
+#ifdef BT_USE_DOUBLE_PRECISION
+	return false;
+#else
+	if (sizeof(btVector3) != HULL_VERTEX_SIZE)
+	{
+		return false;
+	}
+
+	// Map the whole file, copy-on-write since Bullet takes non-const vertices
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	mSize = GetFileSize(file, NULL);
+	mMapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+	CloseHandle(file);
+	if (mMapping == NULL)
+	{
+		return false;
+	}
+	mData = MapViewOfFile(mMapping, FILE_MAP_COPY, 0, 0, 0);
+#else
+	int file = ::open(path.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+	struct stat info;
+	if (fstat(file, &info) == 0)
+	{
+		mSize = info.st_size;
+		mData = mmap(NULL, mSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+		if (mData == MAP_FAILED)
+		{
+			mData = NULL;
+		}
+	}
+	::close(file);
+#endif
+	if (mData == NULL)
+	{
+		close();
+		return false;
+	}
+
+	// Header check
+	const Ogre::uint32* header = (const Ogre::uint32*)mData;
+	if (mSize < HULL_HEADER_SIZE || header[0] != HULL_MAGIC || header[1] != HULL_VERSION)
+	{
+		close();
+		return false;
+	}
+	mHullCount = header[2];
+	Ogre::uint32 vertexCount = header[3];
+	size_t vertexOffset = getVertexOffset(mHullCount);
+	if (mSize < vertexOffset + vertexCount * HULL_VERTEX_SIZE)
+	{
+		close();
+		return false;
+	}
+
+	// Pointer fixups
+	mHulls = header + 4;
+	mVertices = (btVector3*)((char*)mData + vertexOffset);
+	for (Ogre::uint32 i = 0; i < mHullCount; i++)
+	{
+		if (mHulls[2 * i] + mHulls[2 * i + 1] > vertexCount)
+		{
+			close();
+			return false;
+		}
+	}
+	return true;
+#endif
+}
+
+
+btCollisionShape* HullFile::createShape(Vector3 scale)
+{
+	btCompoundShape* compound = NULL;
+	btCollisionShape* shape = NULL;
+	btTransform identity;
+	identity.setIdentity();
+
+	for (Ogre::uint32 i = 0; i < mHullCount; i++)
+	{
+		// The shape reads the mapped vertices directly
+		btConvexPointCloudShape* hull = new btConvexPointCloudShape(
+			mVertices + mHulls[2 * i],
+			mHulls[2 * i + 1],
+			btVector3(scale.x, scale.y, scale.z));
+
+		// Several hulls : compound decomposition
+		if (shape)
+		{
+			if (!compound)
+			{
+				compound = new btCompoundShape(true);
+				compound->addChildShape(identity, shape);
+				shape = compound;
+			}
+			compound->addChildShape(identity, hull);
+		}
+		else
+		{
+			shape = hull;
+		}
+	}
+	return shape;
+}
+
+
+size_t HullFile::getHullCount()
+{
+	return mHullCount;
+}
+
+
+bool HullFile::write(String path, const Ogre::vector<Ogre::vector<Vector3>::type>::type& hulls)
+{
+	std::ofstream file(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	// Header
+	Ogre::uint32 vertexCount = 0;
+	for (size_t i = 0; i < hulls.size(); i++)
+	{
+		vertexCount += (Ogre::uint32)hulls[i].size();
+	}
+	Ogre::uint32 header[4] = {HULL_MAGIC, HULL_VERSION, (Ogre::uint32)hulls.size(), vertexCount};
+	file.write((const char*)header, sizeof(header));
+
+	// Hull table
+	Ogre::uint32 first = 0;
+	for (size_t i = 0; i < hulls.size(); i++)
+	{
+		Ogre::uint32 entry[2] = {first, (Ogre::uint32)hulls[i].size()};
+		file.write((const char*)entry, sizeof(entry));
+		first += entry[1];
+	}
+
+	// Padding
+	size_t padding = getVertexOffset(hulls.size()) - HULL_HEADER_SIZE - 2 * sizeof(Ogre::uint32) * hulls.size();
+	for (size_t i = 0; i < padding; i++)
+	{
+		file.put(0);
+	}
+
+	// Vertices
+	for (size_t i = 0; i < hulls.size(); i++)
+	{
+		for (size_t j = 0; j < hulls[i].size(); j++)
+		{
+			float vertex[4] = {hulls[i][j].x, hulls[i][j].y, hulls[i][j].z, 0};
+			file.write((const char*)vertex, sizeof(vertex));
+		}
+	}
+	return file.good();
+}
+
+
+/*----------------------------------------------
+	Private methods
+----------------------------------------------*/
+
+void HullFile::close()
+{
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+	if (mData)
+	{
+		UnmapViewOfFile(mData);
+	}
+	if (mMapping)
+	{
+		CloseHandle(mMapping);
+	}
+#else
+	if (mData)
+	{
+		munmap(mData, mSize);
+	}
+#endif
+	mData = NULL;
+	mSize = 0;
+	mMapping = NULL;
+	mHullCount = 0;
+	mHulls = NULL;
+	mVertices = NULL;
+}
@@ -0,0 +1,90 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#ifndef __HULL_FILE_H_
+#define __HULL_FILE_H_
+
+#include "Engine/Rendering/renderer.hpp"
+#include "Engine/bulletphysics.hpp"
+#include "Engine/gametypes.hpp"
+
+
+/*----------------------------------------------
+	Baked hull file (.hull, next to the .mesh)
+
+	Header		magic, version, hull count, vertex count (4 x uint32)
+	Hulls		first vertex, vertex count (2 x uint32 per hull)
+	Vertices	x, y, z, 0 (4 x float per vertex, 16-byte aligned)
+----------------------------------------------*/
+
+class HullFile
+{
+
+public:
+
+	/**
+	 * @brief Create an empty hull file
+	 **/
+	HullFile();
+
+	/**
+	 * @brief Unmap the file
+	 **/
+	~HullFile();
+
+	/**
+	 * @brief Map a baked file in memory
+	 * @param path			File path
+	 * @return false if the file is missing or invalid
+	 **/
+	bool open(String path);
+
+	/**
+	 * @brief Create a collision shape that points into the mapped data
+	 * @param scale			Mesh scale
+	 * @return a hull, or a compound of hulls if there are several, to delete with its children
+	 **/
+	btCollisionShape* createShape(Vector3 scale);
+
+	/**
+	 * @brief Get the hull count
+	 * @return the number of hulls
+	 **/
+	size_t getHullCount();
+
+	/**
+	 * @brief Write a baked file
+	 * @param path			File path
+	 * @param hulls			Hull vertices, one list per hull
+	 * @return false if the file could not be written
+	 **/
+	static bool write(String path, const Ogre::vector<Ogre::vector<Vector3>::type>::type& hulls);
+
+
+protected:
+
+	/**
+	 * @brief Unmap the file
+	 **/
+	void close();
+
+
+protected:
+
+	// Mapped data
+	void* mData;
+	size_t mSize;
+	void* mMapping;
+
+	// Pointers into the mapped data
+	Ogre::uint32 mHullCount;
+	const Ogre::uint32* mHulls;
+	btVector3* mVertices;
+
+};
+
+#endif /* __HULL_FILE_H_ */
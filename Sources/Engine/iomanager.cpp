@@ -9,6 +9,7 @@
 #include "Engine/game.hpp"
 #include "Engine/actor.hpp"
 #include "Engine/player.hpp"
+#include "Engine/profiler.hpp"
 
 
 /*----------------------------------------------
@@ -98,9 +99,12 @@ void IOManager::prerender(const Ogre::FrameEvent& evt)
 	}
 	
 	// Peripheral capture
-	mMouse->capture();
-	mKeyboard->capture();
-	if (mJoy) mJoy->capture();
+	{
+		ProfileZone zone("Input");
+		mMouse->capture();
+		mKeyboard->capture();
+		if (mJoy) mJoy->capture();
+	}
 
 	// Debug
 	mDebugText = mPlayer->debugText();
@@ -120,11 +124,14 @@ void IOManager::postrender(const Ogre::FrameEvent& evt)
 		guiBatches->setCaption(StringConverter::toString(stats.batchCount) + " batches");
 
 		Ogre::OverlayElement* guiDbg = Ogre::OverlayManager::getSingleton().getOverlayElement("Core/DebugText");
-		guiDbg->setCaption(mDebugText);
+		guiDbg->setCaption(mDebugText + "\n" + Profiler::get().getReport());
 
-		Ogre::OverlayElement* deleted = Ogre::OverlayManager::getSingleton().getOverlayElement("Core/AverageFps");
-		deleted->setCaption("");
-		deleted = Ogre::OverlayManager::getSingleton().getOverlayElement("Core/BestFps");
+		Ogre::OverlayElement* guiActors = Ogre::OverlayManager::getSingleton().getOverlayElement("Core/AverageFps");
+		guiActors->setCaption(StringConverter::toString(mGame->getAwakeActorCount()) + " / "
+			+ StringConverter::toString(mGame->getActorCount()) + " actors awake, "
+			+ StringConverter::toString(mGame->getMovingBodyCount()) + " moving");
+
+		Ogre::OverlayElement* deleted = Ogre::OverlayManager::getSingleton().getOverlayElement("Core/BestFps");
 		deleted->setCaption("");
 		deleted = Ogre::OverlayManager::getSingleton().getOverlayElement("Core/WorstFps");
 		deleted->setCaption("");
@@ -0,0 +1,197 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#include "Engine/jobsystem.hpp"
+
+
+/*----------------------------------------------
+	Constructor & destructor
+----------------------------------------------*/
+
+JobSystem::JobSystem(int threads)
+{
+	mQueued = 0;
+	bExiting = false;
+
+	if (threads <= 0)
+	{
+		threads = (int)std::thread::hardware_concurrency() - 1;
+	}
+	if (threads < 0)
+	{
+		threads = 0;
+	}
+
+	// One queue per thread, including the caller
+	for (int i = 0; i <= threads; i++)
+	{
+		mQueues.push_back(new Queue);
+	}
+	for (int i = 0; i < threads; i++)
+	{
+		mThreads.push_back(new std::thread(&JobSystem::run, this, i + 1));
+	}
+}
+
+
+JobSystem::~JobSystem()
+{
+	{
+		std::unique_lock<std::mutex> lock(mWakeMutex);
+		bExiting = true;
+	}
+	mWake.notify_all();
+
+	for (size_t i = 0; i < mThreads.size(); i++)
+	{
+		mThreads[i]->join();
+		delete mThreads[i];
+	}
+	for (size_t i = 0; i < mQueues.size(); i++)
+	{
+		delete mQueues[i];
+	}
+}
+
+
+/*----------------------------------------------
+	Public methods
+----------------------------------------------*/
+
+void JobSystem::parallelFor(size_t count, size_t grain, JobFunction function, void* data)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	if (grain == 0)
+	{
+		grain = 1;
+	}
+
+	// Not worth splitting
+	size_t jobCount = (count + grain - 1) / grain;
+	if (mThreads.empty() || jobCount == 1)
+	{
+		function(data, 0, count);
+		return;
+	}
+
+	// Deal the jobs to all queues, idle threads will steal from the busy ones
+	std::atomic<size_t> remaining(jobCount);
+	for (size_t i = 0; i < jobCount; i++)
+	{
+		Job job;
+		job.function = function;
+		job.data = data;
+		job.begin = i * grain;
+		job.end = std::min(count, job.begin + grain);
+		job.remaining = &remaining;
+
+		Queue* queue = mQueues[i % mQueues.size()];
+		std::unique_lock<std::mutex> lock(queue->mutex);
+		queue->jobs.push_back(job);
+	}
+	mQueued += (int)jobCount;
+	{
+		std::unique_lock<std::mutex> lock(mWakeMutex);
+	}
+	mWake.notify_all();
+
+	// Work on the calling thread too, until everything is done
+	while (remaining > 0)
+	{
+		Job job;
+		if (take(0, job))
+		{
+			execute(job);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+
+int JobSystem::getThreadCount()
+{
+	return (int)mThreads.size();
+}
+
+
+/*----------------------------------------------
+	Private methods
+----------------------------------------------*/
+
+void JobSystem::run(size_t index)
+{
+	while (true)
+	{
+		Job job;
+		if (take(index, job))
+		{
+			execute(job);
+			continue;
+		}
+
+		// Nothing left anywhere : sleep until the next batch
+		std::unique_lock<std::mutex> lock(mWakeMutex);
+		while (mQueued == 0 && !bExiting)
+		{
+			mWake.wait(lock);
+		}
+		if (bExiting)
+		{
+			break;
+		}
+	}
+}
+
+
+bool JobSystem::take(size_t index, Job& job)
+{
+	if (mQueued == 0)
+	{
+		return false;
+	}
+
+	// Own queue first, newest job
+	{
+		Queue* queue = mQueues[index];
+		std::unique_lock<std::mutex> lock(queue->mutex);
+		if (!queue->jobs.empty())
+		{
+			job = queue->jobs.back();
+			queue->jobs.pop_back();
+			mQueued--;
+			return true;
+		}
+	}
+
+	// Steal the oldest job of another thread
+	for (size_t i = 1; i < mQueues.size(); i++)
+	{
+		Queue* queue = mQueues[(index + i) % mQueues.size()];
+		std::unique_lock<std::mutex> lock(queue->mutex);
+		if (!queue->jobs.empty())
+		{
+			job = queue->jobs.front();
+			queue->jobs.pop_front();
+			mQueued--;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+void JobSystem::execute(Job& job)
+{
+	job.function(job.data, job.begin, job.end);
+	(*job.remaining)--;
+}
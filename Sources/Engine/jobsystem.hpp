@@ -0,0 +1,125 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#ifndef __JOB_SYSTEM_H_
+#define __JOB_SYSTEM_H_
+
+#include "Engine/Rendering/renderer.hpp"
+#include "Engine/gametypes.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+
+/*----------------------------------------------
+	Definitions
+----------------------------------------------*/
+
+/**
+ * @brief Job body, called for a range of items
+ * @param data			User data
+ * @param begin			First item
+ * @param end			Item after the last one
+ **/
+typedef void (*JobFunction)(void* data, size_t begin, size_t end);
+
+
+/*----------------------------------------------
+	Work-stealing job system
+----------------------------------------------*/
+
+class JobSystem
+{
+
+public:
+
+	/**
+	 * @brief Start the worker threads
+	 * @param threads		Worker count, 0 for one per core besides the calling thread
+	 **/
+	JobSystem(int threads = 0);
+
+	/**
+	 * @brief Stop the workers
+	 **/
+	~JobSystem();
+
+	/**
+	 * @brief Split a range in jobs, run them on all threads and wait for completion
+	 * @brief Must be called from the thread that created the job system
+	 * @param count			Item count
+	 * @param grain			Maximum item count per job
+	 * @param function		Job body
+	 * @param data			User data
+	 **/
+	void parallelFor(size_t count, size_t grain, JobFunction function, void* data);
+
+	/**
+	 * @brief Get the worker count
+	 * @return the number of threads, excluding the calling thread
+	 **/
+	int getThreadCount();
+
+
+protected:
+
+	// Job range
+	typedef struct
+	{
+		JobFunction function;
+		void* data;
+		size_t begin;
+		size_t end;
+		std::atomic<size_t>* remaining;
+	} Job;
+
+	// Per-thread job queue
+	typedef struct
+	{
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	} Queue;
+
+	/**
+	 * @brief Worker loop
+	 * @param index			Own queue index
+	 **/
+	void run(size_t index);
+
+	/**
+	 * @brief Get a job : newest from the own queue, or oldest from another one
+	 * @param index			Own queue index
+	 * @param job			Output job
+	 * @return false if all queues are empty
+	 **/
+	bool take(size_t index, Job& job);
+
+	/**
+	 * @brief Run a job and mark it as done
+	 * @param job			Job to run
+	 **/
+	void execute(Job& job);
+
+
+protected:
+
+	// Queues, the first one belongs to the calling thread
+	Ogre::vector<Queue*>::type mQueues;
+	Ogre::vector<std::thread*>::type mThreads;
+	std::atomic<int> mQueued;
+
+	// Sleep data
+	std::mutex mWakeMutex;
+	std::condition_variable mWake;
+	bool bExiting;
+
+};
+
+#endif /* __JOB_SYSTEM_H_ */
@@ -6,7 +6,9 @@
 **/
 
 #include "Engine/meshactor.hpp"
+#include "Engine/collisioncache.hpp"
 #include "Engine/componentactor.hpp"
+#include "Engine/motionstate.hpp"
 
 
 /*----------------------------------------------
@@ -76,12 +78,25 @@ MeshActor::~MeshActor()
 {
 	if (mPhysBody)
 	{
+		mGame->unregisterForces(&mForces);
 		mGame->unregisterRigidBody(mPhysBody);
+		delete mPhysBody;
+		delete mPhysMotionState;
+	}
+	if (mPhysShape)
+	{
+		for (int i = 0; i < mPhysShape->getNumChildShapes(); i++)
+		{
+			CollisionShapeCache::get().release(mPhysShape->getChildShape(i));
+		}
+		delete mPhysShape;
 	}
 }
 
 void MeshActor::init() {
 	mPhysBody = NULL;
+	mPhysShape = NULL;
+	mPhysMotionState = NULL;
 	mRootComponent = new ComponentActor(mGame, mName + "_root");
 	attachComponent(mRootComponent);
 }
@@ -91,17 +106,22 @@ void MeshActor::init() {
 	Methods
 ----------------------------------------------*/
 
-void MeshActor::tick(const Ogre::FrameEvent& evt)
+bool MeshActor::isAwake()
+{
+	if (mPhysBody)
+	{
+		return mPhysBody->isActive();
+	}
+	return Actor::isAwake();
+}
+
+
+void MeshActor::wake()
 {
 	if (mPhysBody)
 	{
-		mPhysTransform = mPhysBody->getWorldTransform();
-		btQuaternion rotation(mPhysTransform.getRotation());
-		mNode->setOrientation(rotation.getW(), rotation.getX(), rotation.getY(), rotation.getZ());
-		const btVector3 &origin = mPhysTransform.getOrigin();
-		mNode->setPosition(origin.getX(), origin.getY(), origin.getZ());
+		mPhysBody->activate(true);
 	}
-	Actor::tick(evt);
 }
 
 
@@ -148,11 +168,12 @@ void MeshActor::setLocation(Vector3 newPos)
 {
 	if (mPhysBody)
 	{
-		mPhysTransform.setOrigin(btVector3(
+		btTransform transform = mPhysMotionState->getTransform();
+		transform.setOrigin(btVector3(
 			newPos[0],
 			newPos[1],
 			newPos[2]));
-		mPhysBody->setWorldTransform(mPhysTransform);
+		setPhysTransform(transform);
 	}
 	else
 	{
@@ -166,8 +187,9 @@ void MeshActor::setRotation(Quaternion newRot)
 	if (mPhysBody)
 	{
 		btQuaternion quat(newRot.x, newRot.y, newRot.z, newRot.w);
-		mPhysTransform.setRotation(quat);
-		mPhysBody->setWorldTransform(mPhysTransform);
+		btTransform transform = mPhysMotionState->getTransform();
+		transform.setRotation(quat);
+		setPhysTransform(transform);
 	}
 	else
 	{
@@ -188,12 +210,13 @@ void MeshActor::translate(Vector3 offset, bool bRelative)
 {
 	if (mPhysBody)
 	{
-		btVector3 base = mPhysTransform.getOrigin();
-		mPhysTransform.setOrigin(btVector3(
+		btTransform transform = mPhysMotionState->getTransform();
+		btVector3 base = transform.getOrigin();
+		transform.setOrigin(btVector3(
 			base[0] + offset[0],
 			base[1] + offset[1],
 			base[2] + offset[2]));
-		mPhysBody->setWorldTransform(mPhysTransform);
+		setPhysTransform(transform);
 	}
 	else
 	{
@@ -207,8 +230,9 @@ void MeshActor::rotate(Quaternion rotator)
 	if (mPhysBody)
 	{
 		btQuaternion quat(rotator.x, rotator.y, rotator.z, rotator.w);
-		mPhysTransform.setRotation( mPhysTransform.getRotation() * quat);
-		mPhysBody->getMotionState()->setWorldTransform(mPhysTransform);
+		btTransform transform = mPhysMotionState->getTransform();
+		transform.setRotation(transform.getRotation() * quat);
+		setPhysTransform(transform);
 	}
 	else
 	{
@@ -217,14 +241,32 @@ void MeshActor::rotate(Quaternion rotator)
 }
 
 
+void MeshActor::setContinuousCollision(Real motionThreshold, Real sweptRadius)
+{
+	if (mPhysBody)
+	{
+		mPhysBody->setCcdMotionThreshold(motionThreshold);
+		mPhysBody->setCcdSweptSphereRadius(sweptRadius);
+	}
+}
+
+
+void MeshActor::rebase(Vector3 shift)
+{
+	// The body itself is moved by Game with all collision objects
+	if (mPhysMotionState)
+	{
+		mPhysMotionState->rebase(btVector3(shift.x, shift.y, shift.z));
+	}
+	Actor::rebase(shift);
+}
+
+
 void MeshActor::applyForce(Vector3 force, Vector3 location)
 {
 	if (mPhysBody)
 	{
-		mPhysBody->setActivationState(DISABLE_DEACTIVATION);
-		btVector3 f = btVector3(force[0], force[1], force[2]);
-		btVector3 p = btVector3(location[0], location[1], location[2]);
-		mPhysBody->applyForce(f, p);
+		mForces.addForce(force, location);
 	}
 }
 
@@ -233,12 +275,7 @@ void MeshActor::applyLocalForce(Vector3 force, Vector3 location)
 {
 	if (mPhysBody)
 	{
-		mPhysBody->setActivationState(DISABLE_DEACTIVATION);
-		btVector3 f = btVector3(force[0], force[1], force[2]);
-		btVector3 p = btVector3(location[0], location[1], location[2]);
-		f = mPhysTransform.getBasis() * f;
-		p = mPhysTransform.getBasis() * p;
-		mPhysBody->applyForce(f, p);
+		mForces.addLocalForce(force, location);
 	}
 }
 
@@ -247,6 +284,7 @@ void MeshActor::clearForces()
 {
 	if (mPhysBody)
 	{
+		mForces.clear();
 		mPhysBody->clearForces();
 	}
 }
@@ -286,7 +324,7 @@ Vector3 MeshActor::getLocalSpeed(void)
 {
 	if (mPhysBody)
 	{
-		btVector3 speed = mPhysBody->getLinearVelocity() * mPhysTransform.getBasis();
+		btVector3 speed = mPhysBody->getLinearVelocity() * mPhysMotionState->getTransform().getBasis();
 		return Vector3(speed[0], speed[1], speed[2]);
 	}
 	else
@@ -314,7 +352,7 @@ Vector3 MeshActor::getLocalAngularSpeed(void)
 {
 	if (mPhysBody)
 	{
-		btVector3 angularSpeed = mPhysBody->getAngularVelocity() * mPhysTransform.getBasis();
+		btVector3 angularSpeed = mPhysBody->getAngularVelocity() * mPhysMotionState->getTransform().getBasis();
 		return Vector3(angularSpeed[0], angularSpeed[1], angularSpeed[2]);
 	}
 	else
@@ -324,11 +362,17 @@ Vector3 MeshActor::getLocalAngularSpeed(void)
 }
 
 
+btRigidBody* MeshActor::getPhysBody()
+{
+	return mPhysBody;
+}
+
+
 Quaternion MeshActor::getRotation()
 {
 	if (mPhysBody)
 	{
-		btQuaternion rotation(mPhysTransform.getRotation());
+		btQuaternion rotation(mPhysMotionState->getTransform().getRotation());
 		return Quaternion(rotation.getW(), rotation.getX(), rotation.getY(), rotation.getZ());
 	}
 	else
@@ -341,7 +385,7 @@ Vector3 MeshActor::getLocation()
 {
 	if (mPhysBody)
 	{
-		const btVector3 &origin = mPhysTransform.getOrigin();
+		const btVector3 &origin = mPhysMotionState->getTransform().getOrigin();
 		return Vector3(origin.getX(), origin.getY(), origin.getZ());
 	}
 	else
@@ -361,6 +405,12 @@ Vector3 MeshActor::getGlobalPosition(Vector3 position)
 	Collisions
 ----------------------------------------------*/
 
+void MeshActor::setPhysTransform(const btTransform& transform)
+{
+	mPhysMotionState->teleport(transform);
+	mPhysBody->setWorldTransform(transform);
+}
+
 void MeshActor::addCollisionMesh(ComponentActor* component)
 {
 	btCollisionShape* mesh = component->getCollisionMesh(false);
@@ -399,13 +449,14 @@ void MeshActor::generateCollisions()
 	}
 	mPhysShape->recalculateLocalAabb();
 	
-	mPhysTransform.setIdentity();
-	mPhysTransform.setOrigin(btVector3(0, 0, 0));
+	btTransform transform;
+	transform.setIdentity();
+	transform.setOrigin(btVector3(0, 0, 0));
 	btVector3 localInertia(0,0,0);
 	
-	// Physics setup
+	// Physics setup : the motion state moves the node when Bullet moves the body
 	mPhysShape->calculateLocalInertia(mPhysMass, localInertia);
-	mPhysMotionState = new btDefaultMotionState(mPhysTransform);
+	mPhysMotionState = new ActorMotionState(mGame, mNode, transform);
 	btRigidBody::btRigidBodyConstructionInfo rbConstruct(
 		mPhysMass,
 		mPhysMotionState,
@@ -415,6 +466,8 @@ void MeshActor::generateCollisions()
 	// End
 	mPhysBody = new btRigidBody(rbConstruct);
 	mGame->registerRigidBody(mPhysBody);
+	mForces.setBody(mPhysBody);
+	mGame->registerForces(&mForces);
 	
 	gameLog("generateCollisions done");
 }
@@ -445,3 +498,9 @@ void MeshActor::setMaterialParam(int index, Vector4 val)
 {
 	mRootComponent->setMaterialParam(index, val);
 }
+
+
+void MeshActor::setMaterialParams(int first, const Vector4* values, int count)
+{
+	mRootComponent->setMaterialParams(first, values, count);
+}
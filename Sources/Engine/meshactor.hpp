@@ -11,6 +11,8 @@
 #include "Engine/game.hpp"
 #include "Engine/actor.hpp"
 #include "Engine/bulletphysics.hpp"
+#include "Engine/forceaccumulator.hpp"
+#include "Engine/motionstate.hpp"
 #include "Engine/gametypes.hpp"
 
 class Game;
@@ -76,10 +78,16 @@ public:
 	virtual ~MeshActor();
 	
 	/**
-	 * @brief Main tick event
-	 * @param evt			Frame event
+	 * @brief Skip the ticks while the rigid body is deactivated,
+	 * or while the parent sleeps for actors without a body
+	 * @return false if the body sleeps
 	 **/
-	virtual void tick(const Ogre::FrameEvent& evt);
+	virtual bool isAwake();
+	
+	/**
+	 * @brief Wake the rigid body up, for commands that will move it
+	 **/
+	void wake();
 	
 	/**
 	 * @brief Set a new mesh from file name
@@ -129,21 +137,34 @@ public:
 	virtual void rotate(Quaternion rotator);
 	
 	/**
-	 * @brief Apply a physical force
+	 * @brief Enable continuous collision detection for fast bodies
+	 * @param motionThreshold	Motion per step above which CCD is used, 0 to disable
+	 * @param sweptRadius		Radius of the sphere swept along the motion
+	 **/
+	void setContinuousCollision(Real motionThreshold, Real sweptRadius);
+	
+	/**
+	 * @brief World origin change : move the body and the node
+	 * @param shift			Offset to add to the local position
+	 **/
+	virtual void rebase(Vector3 shift);
+	
+	/**
+	 * @brief Apply a physical force at the next physics step, callable from any thread
 	 * @param force			Force data
 	 * @param location		Force relative location
 	 **/
 	void applyForce(Vector3 force, Vector3 location);
 
 	/**
-	 * @brief Apply a physical force in the local referencial
+	 * @brief Apply a physical force in the local referencial at the next physics step, callable from any thread
 	 * @param force			Force data
 	 * @param location		Force relative location
 	 **/
 	void applyLocalForce(Vector3 force, Vector3 location);
 	
 	/**
-	 * @brief Remove all physical forces
+	 * @brief Remove all physical forces, including the pending ones
 	 **/
 	void clearForces();
 	
@@ -176,6 +197,12 @@ public:
 	 * @return a vector materializing position along X, Y, Z
 	 **/
 	Vector3 getGlobalPosition(Vector3 position);
+	
+	/**
+	 * @brief Get the physical body
+	 * @return the rigid body, or NULL if there is none
+	 **/
+	btRigidBody* getPhysBody();
 
 	Quaternion getRotation();
 
@@ -207,6 +234,14 @@ public:
 	 * @param val			Parameter value
 	 **/
 	void setMaterialParam(int index, Vector4 val);
+	
+	/**
+	 * @brief Set consecutive material parameters, uploaded with the next frame
+	 * @param first			First parameter index
+	 * @param values		Parameter values
+	 * @param count			Value count
+	 **/
+	void setMaterialParams(int first, const Vector4* values, int count);
 
 	void attachComponent(ComponentActor* component);
 
@@ -224,6 +259,12 @@ protected:
 
 	void addCollisionMesh(ComponentActor* component);
 	
+	/**
+	 * @brief Move the rigid body and its node at once
+	 * @param transform		New transform
+	 **/
+	void setPhysTransform(const btTransform& transform);
+	
 
 protected:
 
@@ -231,9 +272,9 @@ protected:
 	// Physics data
 	btScalar mPhysMass;
 	btRigidBody* mPhysBody;
-	btTransform mPhysTransform;
 	btCompoundShape* mPhysShape;
-	btDefaultMotionState* mPhysMotionState;
+	ActorMotionState* mPhysMotionState;
+	ForceAccumulator mForces;
 
 	// Game data
 	ComponentActor* mRootComponent;
@@ -0,0 +1,119 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#include "Engine/motionstate.hpp"
+#include "Engine/game.hpp"
+
+
+/*----------------------------------------------
+	Constructor & destructor
+----------------------------------------------*/
+
+ActorMotionState::ActorMotionState(Game* g, Ogre::SceneNode* node, const btTransform& transform)
+{
+	mGame = g;
+	mNode = node;
+	mTransform = transform;
+	mPreviousTransform = transform;
+	bMoving = false;
+	bMoved = false;
+}
+
+
+ActorMotionState::~ActorMotionState()
+{
+	if (bMoving)
+	{
+		mGame->unregisterMovingBody(this);
+	}
+}
+
+
+/*----------------------------------------------
+	Bullet interface
+----------------------------------------------*/
+
+void ActorMotionState::getWorldTransform(btTransform& transform) const
+{
+	transform = mTransform;
+}
+
+
+void ActorMotionState::setWorldTransform(const btTransform& transform)
+{
+	mPreviousTransform = mTransform;
+	mTransform = transform;
+	bMoved = true;
+	if (!bMoving)
+	{
+		bMoving = true;
+		mGame->registerMovingBody(this);
+	}
+}
+
+
+/*----------------------------------------------
+	Public methods
+----------------------------------------------*/
+
+void ActorMotionState::teleport(const btTransform& transform)
+{
+	mTransform = transform;
+	mPreviousTransform = transform;
+	push(transform);
+}
+
+
+void ActorMotionState::rebase(const btVector3& shift)
+{
+	mTransform.getOrigin() += shift;
+	mPreviousTransform.getOrigin() += shift;
+}
+
+
+bool ActorMotionState::endStep()
+{
+	if (bMoved)
+	{
+		bMoved = false;
+		return true;
+	}
+
+	// Resting : last node update at the final transform
+	mPreviousTransform = mTransform;
+	push(mTransform);
+	bMoving = false;
+	return false;
+}
+
+
+void ActorMotionState::interpolate(Real alpha)
+{
+	btTransform transform;
+	transform.setRotation(mPreviousTransform.getRotation().slerp(mTransform.getRotation(), alpha));
+	transform.setOrigin(mPreviousTransform.getOrigin().lerp(mTransform.getOrigin(), alpha));
+	push(transform);
+}
+
+
+const btTransform& ActorMotionState::getTransform() const
+{
+	return mTransform;
+}
+
+
+/*----------------------------------------------
+	Protected methods
+----------------------------------------------*/
+
+void ActorMotionState::push(const btTransform& transform)
+{
+	btQuaternion rotation = transform.getRotation();
+	const btVector3& origin = transform.getOrigin();
+	mNode->setOrientation(rotation.getW(), rotation.getX(), rotation.getY(), rotation.getZ());
+	mNode->setPosition(origin.getX(), origin.getY(), origin.getZ());
+}
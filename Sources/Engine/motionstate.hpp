@@ -0,0 +1,105 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#ifndef __MOTION_STATE_H_
+#define __MOTION_STATE_H_
+
+#include "Engine/bulletphysics.hpp"
+#include "Engine/gametypes.hpp"
+
+class Game;
+
+
+/*----------------------------------------------
+	Rigid body to scene node link
+----------------------------------------------*/
+
+class ActorMotionState : public btMotionState
+{
+
+public:
+
+	/**
+	 * @brief Create the motion state of a body
+	 * @param g				Game actor
+	 * @param node			Scene node to move
+	 * @param transform		Initial transform
+	 **/
+	ActorMotionState(Game* g, Ogre::SceneNode* node, const btTransform& transform);
+
+	/**
+	 * @brief Stop the node updates
+	 **/
+	virtual ~ActorMotionState();
+
+	/**
+	 * @brief Initial body transform, called by Bullet
+	 * @param transform		Output transform
+	 **/
+	virtual void getWorldTransform(btTransform& transform) const;
+
+	/**
+	 * @brief New body transform after a step, only called by Bullet for moving bodies
+	 * @param transform		New transform
+	 **/
+	virtual void setWorldTransform(const btTransform& transform);
+
+	/**
+	 * @brief Move the node at once, without interpolation
+	 * @param transform		New transform
+	 **/
+	void teleport(const btTransform& transform);
+
+	/**
+	 * @brief Move both transforms after a world origin change, the node is moved by the caller
+	 * @param shift			Offset to add
+	 **/
+	void rebase(const btVector3& shift);
+
+	/**
+	 * @brief Close a step : a body that was not moved by this step is left at rest
+	 * @return false if the body stopped moving
+	 **/
+	bool endStep();
+
+	/**
+	 * @brief Move the node between the last two body transforms
+	 * @param alpha			Fraction of a step since the last one (0 - 1)
+	 **/
+	void interpolate(Real alpha);
+
+	/**
+	 * @brief Get the body transform after the last step
+	 * @return the transform
+	 **/
+	const btTransform& getTransform() const;
+
+
+protected:
+
+	/**
+	 * @brief Write a transform to the node
+	 * @param transform		Transform
+	 **/
+	void push(const btTransform& transform);
+
+
+protected:
+
+	// Body data
+	btTransform mTransform;
+	btTransform mPreviousTransform;
+	bool bMoving;
+	bool bMoved;
+
+	// Render data
+	Game* mGame;
+	Ogre::SceneNode* mNode;
+
+};
+
+#endif /* __MOTION_STATE_H_ */
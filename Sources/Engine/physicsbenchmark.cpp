@@ -0,0 +1,61 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#include "Engine/physicsbenchmark.hpp"
+
+#define BENCH_SPACING		6.0f
+#define BENCH_SPEED			10.0f
+
+
+/*----------------------------------------------
+	Constructor & destructor
+----------------------------------------------*/
+
+PhysicsBenchmark::PhysicsBenchmark(btDiscreteDynamicsWorld* world, int bodyCount)
+{
+	mWorld = world;
+	mShape = new btBoxShape(btVector3(1, 1, 1));
+	btVector3 inertia;
+	mShape->calculateLocalInertia(1.0f, inertia);
+
+	// Cubic lattice far from the level, bodies rushing to the center
+	int side = (int)ceil(pow((Real)bodyCount, 1.0f / 3.0f));
+	btVector3 center(0, 0, 10000);
+	for (int i = 0; i < bodyCount; i++)
+	{
+		btVector3 offset(
+			BENCH_SPACING * (i % side - side / 2),
+			BENCH_SPACING * ((i / side) % side - side / 2),
+			BENCH_SPACING * (i / (side * side) - side / 2));
+		btTransform transform;
+		transform.setIdentity();
+		transform.setOrigin(center + offset);
+
+		btRigidBody::btRigidBodyConstructionInfo info(1.0f, new btDefaultMotionState(transform), mShape, inertia);
+		btRigidBody* body = new btRigidBody(info);
+		if (offset.length2() > SIMD_EPSILON)
+		{
+			body->setLinearVelocity(-offset.normalized() * BENCH_SPEED);
+		}
+		body->setAngularVelocity(btVector3(Math::SymmetricRandom(), Math::SymmetricRandom(), Math::SymmetricRandom()));
+		body->setActivationState(DISABLE_DEACTIVATION);
+		mWorld->addRigidBody(body);
+		mBodies.push_back(body);
+	}
+}
+
+
+PhysicsBenchmark::~PhysicsBenchmark()
+{
+	for (size_t i = 0; i < mBodies.size(); i++)
+	{
+		mWorld->removeRigidBody(mBodies[i]);
+		delete mBodies[i]->getMotionState();
+		delete mBodies[i];
+	}
+	delete mShape;
+}
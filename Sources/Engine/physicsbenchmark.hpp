@@ -0,0 +1,45 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#ifndef __PHYSICS_BENCHMARK_H_
+#define __PHYSICS_BENCHMARK_H_
+
+#include "Engine/bulletphysics.hpp"
+#include "Engine/gametypes.hpp"
+
+
+/*----------------------------------------------
+	Rigid body stress scene
+----------------------------------------------*/
+
+class PhysicsBenchmark
+{
+
+public:
+
+	/**
+	 * @brief Fill the world with a cloud of colliding boxes
+	 * @param world			Physics world
+	 * @param bodyCount		Number of rigid bodies
+	 **/
+	PhysicsBenchmark(btDiscreteDynamicsWorld* world, int bodyCount);
+
+	/**
+	 * @brief Remove the bodies from the world
+	 **/
+	~PhysicsBenchmark();
+
+
+protected:
+
+	btDiscreteDynamicsWorld* mWorld;
+	btCollisionShape* mShape;
+	Ogre::vector<btRigidBody*>::type mBodies;
+
+};
+
+#endif /* __PHYSICS_BENCHMARK_H_ */
@@ -0,0 +1,109 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#include "Engine/physicsscheduler.hpp"
+
+#if BT_THREADSAFE
+
+
+/*----------------------------------------------
+	Job adapters
+----------------------------------------------*/
+
+typedef struct
+{
+	int begin;
+	const btIParallelForBody* body;
+} ForData;
+
+typedef struct
+{
+	int begin;
+	size_t grain;
+	const btIParallelSumBody* body;
+	btScalar* sums;
+} SumData;
+
+static void forJob(void* data, size_t begin, size_t end)
+{
+	ForData* forData = (ForData*)data;
+	forData->body->forLoop(forData->begin + (int)begin, forData->begin + (int)end);
+}
+
+static void sumJob(void* data, size_t begin, size_t end)
+{
+	SumData* sumData = (SumData*)data;
+	sumData->sums[begin / sumData->grain] = sumData->body->sumLoop(sumData->begin + (int)begin, sumData->begin + (int)end);
+}
+
+
+/*----------------------------------------------
+	Constructor
+----------------------------------------------*/
+
+PhysicsScheduler::PhysicsScheduler(JobSystem* jobs)
+	: btITaskScheduler("Soyouz")
+{
+	mJobs = jobs;
+}
+
+
+/*----------------------------------------------
+	Public methods
+----------------------------------------------*/
+
+int PhysicsScheduler::getMaxNumThreads() const
+{
+	return mJobs->getThreadCount() + 1;
+}
+
+
+int PhysicsScheduler::getNumThreads() const
+{
+	return mJobs->getThreadCount() + 1;
+}
+
+
+void PhysicsScheduler::setNumThreads(int numThreads)
+{
+}
+
+
+void PhysicsScheduler::parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body)
+{
+	ForData data;
+	data.begin = iBegin;
+	data.body = &body;
+	mJobs->parallelFor(iEnd - iBegin, grainSize, &forJob, &data);
+}
+
+
+btScalar PhysicsScheduler::parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body)
+{
+	if (iEnd <= iBegin)
+	{
+		return 0;
+	}
+
+	// One partial sum per job, added in order for a stable result
+	SumData data;
+	data.begin = iBegin;
+	data.grain = (grainSize > 0) ? grainSize : 1;
+	data.body = &body;
+	Ogre::vector<btScalar>::type sums((iEnd - iBegin + data.grain - 1) / data.grain, 0);
+	data.sums = &sums[0];
+	mJobs->parallelFor(iEnd - iBegin, data.grain, &sumJob, &data);
+
+	btScalar sum = 0;
+	for (size_t i = 0; i < sums.size(); i++)
+	{
+		sum += sums[i];
+	}
+	return sum;
+}
+
+#endif /* BT_THREADSAFE */
@@ -0,0 +1,82 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#ifndef __PHYSICS_SCHEDULER_H_
+#define __PHYSICS_SCHEDULER_H_
+
+#include "Engine/bulletphysics.hpp"
+#include "Engine/jobsystem.hpp"
+
+#if BT_THREADSAFE
+#include "LinearMath/btThreads.h"
+#include "BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h"
+#include "BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h"
+#include "BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h"
+
+
+/*----------------------------------------------
+	Bullet task scheduler on the engine jobs
+----------------------------------------------*/
+
+class PhysicsScheduler : public btITaskScheduler
+{
+
+public:
+
+	/**
+	 * @brief Create the scheduler, call btSetTaskScheduler() to use it
+	 * @param jobs			Engine job system
+	 **/
+	PhysicsScheduler(JobSystem* jobs);
+
+	/**
+	 * @brief Get the maximum thread count
+	 * @return the job system thread count, including the game thread
+	 **/
+	virtual int getMaxNumThreads() const;
+
+	/**
+	 * @brief Get the used thread count
+	 * @return the thread count
+	 **/
+	virtual int getNumThreads() const;
+
+	/**
+	 * @brief Ignored : the thread count is set by the job system
+	 * @param numThreads	Thread count
+	 **/
+	virtual void setNumThreads(int numThreads);
+
+	/**
+	 * @brief Run a Bullet loop over the job system
+	 * @param iBegin		First item
+	 * @param iEnd			Item after the last one
+	 * @param grainSize		Maximum item count per job
+	 * @param body			Loop body
+	 **/
+	virtual void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body);
+
+	/**
+	 * @brief Run a Bullet reduction over the job system
+	 * @param iBegin		First item
+	 * @param iEnd			Item after the last one
+	 * @param grainSize		Maximum item count per job
+	 * @param body			Loop body
+	 * @return the sum of all jobs
+	 **/
+	virtual btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body);
+
+
+protected:
+
+	JobSystem* mJobs;
+
+};
+
+#endif /* BT_THREADSAFE */
+
+#endif /* __PHYSICS_SCHEDULER_H_ */
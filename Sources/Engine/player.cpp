@@ -6,6 +6,7 @@
 **/
 
 #include "Engine/player.hpp"
+#include "Engine/profiler.hpp"
 
 
 /*----------------------------------------------
@@ -41,6 +42,12 @@ void Player::tick(const Ogre::FrameEvent& evt)
 }
 
 
+bool Player::isAwake()
+{
+	return true;
+}
+
+
 Ogre::Camera* Player::getCamera()
 {
 	return mCamera;
@@ -121,6 +128,18 @@ bool Player::keyPressed(const OIS::KeyEvent &e)
 			mGame->setDebugMode(e.key - OIS::KC_F1);
 			break;
 
+		case OIS::KC_F5:
+			mGame->saveWorld();
+			break;
+
+		case OIS::KC_F9:
+			mGame->loadWorld();
+			break;
+
+		case OIS::KC_F6:
+			Profiler::get().startCapture(300);
+			break;
+
 		case OIS::KC_ESCAPE:
 			mGame->quit();
 			break;
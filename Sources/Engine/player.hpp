@@ -42,6 +42,12 @@ public:
 	 **/
 	virtual void tick(const Ogre::FrameEvent& evt);
 	
+	/**
+	 * @brief The player keeps reading its input while its vehicle sleeps
+	 * @return true
+	 **/
+	virtual bool isAwake();
+	
 	/**
 	 * @brief Get the camera data
 	 * @return camera data
@@ -0,0 +1,251 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#include "Engine/profiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+#define PROFILER_HISTORY	240
+#define PROFILER_REFRESH	30
+#define PROFILER_TRACE		"Config/trace.json"
+
+
+/*----------------------------------------------
+	Constructor
+----------------------------------------------*/
+
+Profiler::Profiler()
+{
+	mThread = std::this_thread::get_id();
+	mFrame = 0;
+	mCaptureFrames = 0;
+	mTimer.reset();
+}
+
+
+/*----------------------------------------------
+	Public methods
+----------------------------------------------*/
+
+Profiler& Profiler::get()
+{
+	static Profiler instance;
+	return instance;
+}
+
+
+void Profiler::begin(const char* name, const char* detail)
+{
+	if (!isProfiledThread())
+	{
+		return;
+	}
+
+	// Zones are identified by their name and their parent
+	size_t zone = findZone(mStack.empty() ? -1 : (int)mStack.back().zone, name);
+	OpenZone open;
+	open.zone = zone;
+	open.detail = detail;
+	open.start = mTimer.getMicroseconds();
+	mStack.push_back(open);
+}
+
+
+void Profiler::end()
+{
+	if (!isProfiledThread() || mStack.empty())
+	{
+		return;
+	}
+	OpenZone open = mStack.back();
+	mStack.pop_back();
+
+	unsigned long duration = mTimer.getMicroseconds() - open.start;
+	Zone& zone = mZones[open.zone];
+	zone.frameTime += duration;
+	zone.calls++;
+
+	if (mCaptureFrames > 0)
+	{
+		TraceEvent evt;
+		evt.zone = open.zone;
+		evt.detail = open.detail ? open.detail : "";
+		evt.start = open.start;
+		evt.duration = duration;
+		mTrace.push_back(evt);
+	}
+}
+
+
+void Profiler::endFrame()
+{
+	if (!isProfiledThread())
+	{
+		return;
+	}
+
+	// Store this frame in the rolling history of each zone
+	for (size_t i = 0; i < mZones.size(); i++)
+	{
+		Zone& zone = mZones[i];
+		if (zone.history.size() < PROFILER_HISTORY)
+		{
+			zone.history.push_back(zone.frameTime);
+		}
+		else
+		{
+			zone.history[zone.cursor] = zone.frameTime;
+		}
+		zone.cursor = (zone.cursor + 1) % PROFILER_HISTORY;
+		zone.frameTime = 0;
+		zone.calls = 0;
+	}
+
+	// Statistics are only refreshed from time to time
+	mFrame++;
+	if (mFrame % PROFILER_REFRESH == 0)
+	{
+		mReport = "";
+		for (size_t i = 0; i < mRoots.size(); i++)
+		{
+			reportZone(mRoots[i]);
+		}
+	}
+
+	// Trace capture
+	if (mCaptureFrames > 0)
+	{
+		mCaptureFrames--;
+		if (mCaptureFrames == 0)
+		{
+			writeTrace(PROFILER_TRACE);
+			mTrace.clear();
+		}
+	}
+}
+
+
+void Profiler::startCapture(int frames)
+{
+	if (mCaptureFrames == 0)
+	{
+		mTrace.clear();
+		mCaptureFrames = frames;
+	}
+}
+
+
+String Profiler::getReport()
+{
+	return mReport;
+}
+
+
+/*----------------------------------------------
+	Private methods
+----------------------------------------------*/
+
+size_t Profiler::findZone(int parent, const char* name)
+{
+	const Ogre::vector<size_t>::type& siblings = (parent < 0) ? mRoots : mZones[parent].children;
+	for (size_t i = 0; i < siblings.size(); i++)
+	{
+		if (mZones[siblings[i]].name == name)
+		{
+			return siblings[i];
+		}
+	}
+
+	// New zone : the zone array may move, siblings are only used before
+	Zone zone;
+	zone.name = name;
+	zone.depth = (parent < 0) ? 0 : mZones[parent].depth + 1;
+	zone.calls = 0;
+	zone.frameTime = 0;
+	zone.cursor = 0;
+	zone.history.reserve(PROFILER_HISTORY);
+	mZones.push_back(zone);
+	if (parent < 0)
+	{
+		mRoots.push_back(mZones.size() - 1);
+	}
+	else
+	{
+		mZones[parent].children.push_back(mZones.size() - 1);
+	}
+	return mZones.size() - 1;
+}
+
+
+void Profiler::reportZone(size_t index)
+{
+	const Zone& zone = mZones[index];
+	if (zone.history.empty())
+	{
+		return;
+	}
+
+	// Min, average and 99th percentile over the history, in ms
+	Ogre::vector<unsigned long>::type sorted = zone.history;
+	std::sort(sorted.begin(), sorted.end());
+	unsigned long total = 0;
+	for (size_t i = 0; i < sorted.size(); i++)
+	{
+		total += sorted[i];
+	}
+	size_t p99 = (99 * sorted.size() + 99) / 100 - 1;
+	Real minTime = sorted.front() / 1000.0f;
+	Real avgTime = total / (1000.0f * sorted.size());
+	Real p99Time = sorted[p99] / 1000.0f;
+
+	mReport += String(2 * zone.depth, ' ') + zone.name + " : "
+		+ StringConverter::toString(minTime, 2, 0, ' ', std::ios::fixed) + " / "
+		+ StringConverter::toString(avgTime, 2, 0, ' ', std::ios::fixed) + " / "
+		+ StringConverter::toString(p99Time, 2, 0, ' ', std::ios::fixed) + " ms\n";
+
+	for (size_t i = 0; i < zone.children.size(); i++)
+	{
+		reportZone(zone.children[i]);
+	}
+}
+
+
+void Profiler::writeTrace(String path)
+{
+	std::ofstream file(path.c_str());
+	if (!file.is_open())
+	{
+		return;
+	}
+
+	// Complete events ("X"), timestamps in microseconds
+	file << "{\"traceEvents\":[\n";
+	for (size_t i = 0; i < mTrace.size(); i++)
+	{
+		const TraceEvent& evt = mTrace[i];
+		String detail = evt.detail;
+		StringUtil::trim(detail);
+		detail = StringUtil::replaceAll(StringUtil::replaceAll(detail, "\\", "\\\\"), "\"", "\\\"");
+
+		file << "{\"name\":\"" << mZones[evt.zone].name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+			<< ",\"ts\":" << evt.start << ",\"dur\":" << evt.duration;
+		if (detail.length())
+		{
+			file << ",\"args\":{\"detail\":\"" << detail << "\"}";
+		}
+		file << "}" << (i + 1 < mTrace.size() ? ",\n" : "\n");
+	}
+	file << "]}\n";
+	file.close();
+}
+
+
+bool Profiler::isProfiledThread()
+{
+	return (std::this_thread::get_id() == mThread);
+}
@@ -0,0 +1,214 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#ifndef __PROFILER_H_
+#define __PROFILER_H_
+
+#include "Engine/Rendering/renderer.hpp"
+#include "Engine/gametypes.hpp"
+
+#include <thread>
+
+
+/*----------------------------------------------
+	Frame profiler
+----------------------------------------------*/
+
+class Profiler
+{
+
+public:
+
+	/**
+	 * @brief Get the process-wide profiler, bound to the thread calling it first
+	 * @return the profiler
+	 **/
+	static Profiler& get();
+
+	/**
+	 * @brief Open a zone, nested in the currently open one
+	 * @param name			Zone name (static string)
+	 * @param detail		Extra trace information, or NULL
+	 **/
+	void begin(const char* name, const char* detail = NULL);
+
+	/**
+	 * @brief Close the last open zone
+	 **/
+	void end();
+
+	/**
+	 * @brief Close the frame : store the time spent in each zone
+	 **/
+	void endFrame();
+
+	/**
+	 * @brief Record a Chrome trace of the next frames
+	 * @param frames		Frame count
+	 **/
+	void startCapture(int frames);
+
+	/**
+	 * @brief Get the rolling statistics of all zones, one per line
+	 * @return the report
+	 **/
+	String getReport();
+
+
+protected:
+
+	/**
+	 * @brief Create the profiler
+	 **/
+	Profiler();
+
+	/**
+	 * @brief Find or create a zone
+	 * @param parent		Parent zone index, or -1 for a root zone
+	 * @param name			Zone name
+	 * @return the zone index
+	 **/
+	size_t findZone(int parent, const char* name);
+
+	/**
+	 * @brief Add the statistics of a zone and its children to the report
+	 * @param zone			Zone index
+	 **/
+	void reportZone(size_t zone);
+
+	/**
+	 * @brief Write the captured trace as Chrome trace JSON
+	 * @param path			Output file
+	 **/
+	void writeTrace(String path);
+
+	/**
+	 * @brief Check whether the caller runs on the profiled thread
+	 * @return true if zones are recorded
+	 **/
+	bool isProfiledThread();
+
+
+protected:
+
+	// Per-zone statistics
+	typedef struct
+	{
+		String name;
+		int depth;
+		int calls;
+		unsigned long frameTime;
+		size_t cursor;
+		Ogre::vector<unsigned long>::type history;
+		Ogre::vector<size_t>::type children;
+	} Zone;
+
+	// Open zone
+	typedef struct
+	{
+		size_t zone;
+		const char* detail;
+		unsigned long start;
+	} OpenZone;
+
+	// Trace event
+	typedef struct
+	{
+		size_t zone;
+		String detail;
+		unsigned long start;
+		unsigned long duration;
+	} TraceEvent;
+
+	// Zone data
+	Ogre::vector<Zone>::type mZones;
+	Ogre::vector<size_t>::type mRoots;
+	Ogre::vector<OpenZone>::type mStack;
+
+	// Frame data
+	Ogre::Timer mTimer;
+	std::thread::id mThread;
+	size_t mFrame;
+	String mReport;
+
+	// Trace data
+	int mCaptureFrames;
+	Ogre::vector<TraceEvent>::type mTrace;
+
+};
+
+
+/*----------------------------------------------
+	Scoped profiler zone
+----------------------------------------------*/
+
+class ProfileZone
+{
+
+public:
+
+	/**
+	 * @brief Open a zone until the end of the scope
+	 * @param name			Zone name (static string)
+	 * @param detail		Extra trace information, or NULL
+	 **/
+	ProfileZone(const char* name, const char* detail = NULL)
+	{
+		Profiler::get().begin(name, detail);
+	}
+
+	/**
+	 * @brief Close the zone
+	 **/
+	~ProfileZone()
+	{
+		Profiler::get().end();
+	}
+
+};
+
+
+
+/*----------------------------------------------
+	Scene culling zones
+----------------------------------------------*/
+
+class CullingProfiler : public Ogre::SceneManager::Listener
+{
+
+public:
+
+	/**
+	 * @brief Open a "Culling" zone for a visibility query
+	 * @param source		Scene manager
+	 * @param irs			Illumination stage
+	 * @param v				Viewport, its camera is the zone detail
+	 **/
+	virtual void preFindVisibleObjects(Ogre::SceneManager* source, Ogre::SceneManager::IlluminationRenderStage irs, Ogre::Viewport* v)
+	{
+		const char* detail = NULL;
+		if (v && v->getCamera())
+		{
+			detail = v->getCamera()->getName().c_str();
+		}
+		Profiler::get().begin("Culling", detail);
+	}
+
+	/**
+	 * @brief Close the zone
+	 * @param source		Scene manager
+	 * @param irs			Illumination stage
+	 * @param v				Viewport
+	 **/
+	virtual void postFindVisibleObjects(Ogre::SceneManager* source, Ogre::SceneManager::IlluminationRenderStage irs, Ogre::Viewport* v)
+	{
+		Profiler::get().end();
+	}
+
+};
+
+#endif /* __PROFILER_H_ */
@@ -0,0 +1,285 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#include "Engine/projectiles.hpp"
+
+
+/*----------------------------------------------
+	Hit test callback
+----------------------------------------------*/
+
+class ProjectileRayCallback : public btCollisionWorld::ClosestRayResultCallback
+{
+
+public:
+
+	ProjectileRayCallback(const btVector3& from, const btVector3& to, const btCollisionObject* ignored)
+		: btCollisionWorld::ClosestRayResultCallback(from, to), mIgnored(ignored)
+	{
+	}
+
+	virtual btScalar addSingleResult(btCollisionWorld::LocalRayResult& rayResult, bool normalInWorldSpace)
+	{
+		if (rayResult.m_collisionObject == mIgnored)
+		{
+			return 1.0;
+		}
+		return btCollisionWorld::ClosestRayResultCallback::addSingleResult(rayResult, normalInWorldSpace);
+	}
+
+protected:
+
+	const btCollisionObject* mIgnored;
+
+};
+
+
+/*----------------------------------------------
+	Constructor & destructor
+----------------------------------------------*/
+
+ProjectileManager::ProjectileManager(Ogre::SceneManager* scene, btCollisionWorld* world, size_t capacity, bool bRender)
+{
+	mCount = 0;
+	mHitCount = 0;
+	mSpawnCount = 0;
+	mCapacity = capacity;
+	mWorld = world;
+	mScene = scene;
+	mNode = NULL;
+	mBillboards = NULL;
+
+	// Allocate the whole pool once
+	mPosX.resize(capacity);
+	mPosY.resize(capacity);
+	mPosZ.resize(capacity);
+	mLastX.resize(capacity);
+	mLastY.resize(capacity);
+	mLastZ.resize(capacity);
+	mVelX.resize(capacity);
+	mVelY.resize(capacity);
+	mVelZ.resize(capacity);
+	mLife.resize(capacity);
+	mMass.resize(capacity);
+	mOwner.resize(capacity);
+
+	// One billboard batch for all projectiles, oriented along their velocity
+	if (bRender)
+	{
+		mBillboards = mScene->createBillboardSet("Projectiles", capacity);
+		mBillboards->setMaterialName("MI_Tracer");
+		mBillboards->setBillboardType(Ogre::BBT_ORIENTED_SELF);
+		mBillboards->setDefaultDimensions(0.5f, 8.0f);
+		mBillboards->setAutoextend(false);
+		mBillboards->setCullIndividually(false);
+		mBillboards->setCastShadows(false);
+		mNode = mScene->getRootSceneNode()->createChildSceneNode("Projectiles");
+		mNode->attachObject(mBillboards);
+	}
+}
+
+
+ProjectileManager::~ProjectileManager()
+{
+	if (mBillboards)
+	{
+		mNode->detachAllObjects();
+		mScene->destroyBillboardSet(mBillboards);
+		mScene->destroySceneNode(mNode);
+	}
+}
+
+
+/*----------------------------------------------
+	Public methods
+----------------------------------------------*/
+
+bool ProjectileManager::spawn(Vector3 location, Vector3 velocity, Real lifeTime, Real mass, const btCollisionObject* owner)
+{
+	if (mCount >= mCapacity)
+	{
+		return false;
+	}
+	size_t i = mCount;
+	mCount++;
+	mSpawnCount++;
+
+	mPosX[i] = location.x;
+	mPosY[i] = location.y;
+	mPosZ[i] = location.z;
+	mLastX[i] = location.x;
+	mLastY[i] = location.y;
+	mLastZ[i] = location.z;
+	mVelX[i] = velocity.x;
+	mVelY[i] = velocity.y;
+	mVelZ[i] = velocity.z;
+	mLife[i] = lifeTime;
+	mMass[i] = mass;
+	mOwner[i] = owner;
+	return true;
+}
+
+
+void ProjectileManager::tick(Real dt)
+{
+	integrate(dt);
+	sweep();
+
+	// Expiration
+	size_t i = 0;
+	while (i < mCount)
+	{
+		if (mLife[i] <= 0)
+		{
+			kill(i);
+		}
+		else
+		{
+			i++;
+		}
+	}
+}
+
+
+void ProjectileManager::render(Real alpha)
+{
+	if (!mBillboards)
+	{
+		return;
+	}
+
+	// Rebuild the batch, billboards are recycled by the set's own pool
+	mBillboards->clear();
+	for (size_t i = 0; i < mCount; i++)
+	{
+		Vector3 last(mLastX[i], mLastY[i], mLastZ[i]);
+		Vector3 current(mPosX[i], mPosY[i], mPosZ[i]);
+		Ogre::Billboard* bb = mBillboards->createBillboard(last + alpha * (current - last), Ogre::ColourValue(1.0f, 0.2f, 0.0f));
+		bb->mDirection = Vector3(mVelX[i], mVelY[i], mVelZ[i]).normalisedCopy();
+	}
+	mBillboards->_updateBounds();
+}
+
+
+void ProjectileManager::rebase(Vector3 shift)
+{
+	for (size_t i = 0; i < mCount; i++)
+	{
+		mPosX[i] += shift.x;
+		mPosY[i] += shift.y;
+		mPosZ[i] += shift.z;
+		mLastX[i] += shift.x;
+		mLastY[i] += shift.y;
+		mLastZ[i] += shift.z;
+	}
+}
+
+
+size_t ProjectileManager::getCount()
+{
+	return mCount;
+}
+
+
+unsigned long ProjectileManager::getHitCount()
+{
+	return mHitCount;
+}
+
+
+unsigned long ProjectileManager::getSpawnCount()
+{
+	return mSpawnCount;
+}
+
+
+/*----------------------------------------------
+	Protected methods
+----------------------------------------------*/
+
+void ProjectileManager::integrate(Real dt)
+{
+	size_t n = mCount;
+	Real* px = n ? &mPosX[0] : NULL;
+	Real* py = n ? &mPosY[0] : NULL;
+	Real* pz = n ? &mPosZ[0] : NULL;
+	Real* lx = n ? &mLastX[0] : NULL;
+	Real* ly = n ? &mLastY[0] : NULL;
+	Real* lz = n ? &mLastZ[0] : NULL;
+	const Real* vx = n ? &mVelX[0] : NULL;
+	const Real* vy = n ? &mVelY[0] : NULL;
+	const Real* vz = n ? &mVelZ[0] : NULL;
+	Real* life = n ? &mLife[0] : NULL;
+
+	// Straight loops over contiguous arrays, left for the compiler to vectorize
+	for (size_t i = 0; i < n; i++)
+	{
+		lx[i] = px[i];
+		ly[i] = py[i];
+		lz[i] = pz[i];
+	}
+	for (size_t i = 0; i < n; i++)
+	{
+		px[i] += vx[i] * dt;
+		py[i] += vy[i] * dt;
+		pz[i] += vz[i] * dt;
+		life[i] -= dt;
+	}
+}
+
+
+void ProjectileManager::sweep()
+{
+	for (size_t i = 0; i < mCount; i++)
+	{
+		btVector3 from(mLastX[i], mLastY[i], mLastZ[i]);
+		btVector3 to(mPosX[i], mPosY[i], mPosZ[i]);
+		ProjectileRayCallback cb(from, to, mOwner[i]);
+		mWorld->rayTest(from, to, cb);
+
+		if (cb.hasHit())
+		{
+			// Push the target body from the impact point
+			btRigidBody* body = const_cast<btRigidBody*>(btRigidBody::upcast(cb.m_collisionObject));
+			if (body && !body->isStaticOrKinematicObject())
+			{
+				btVector3 impulse = mMass[i] * btVector3(mVelX[i], mVelY[i], mVelZ[i]);
+				body->activate(true);
+				body->applyImpulse(impulse, cb.m_hitPointWorld - body->getCenterOfMassPosition());
+			}
+
+			// Stop on impact, expiration removes it
+			mPosX[i] = cb.m_hitPointWorld.x();
+			mPosY[i] = cb.m_hitPointWorld.y();
+			mPosZ[i] = cb.m_hitPointWorld.z();
+			mLife[i] = 0;
+			mHitCount++;
+		}
+	}
+}
+
+
+void ProjectileManager::kill(size_t i)
+{
+	size_t last = mCount - 1;
+	if (i != last)
+	{
+		mPosX[i] = mPosX[last];
+		mPosY[i] = mPosY[last];
+		mPosZ[i] = mPosZ[last];
+		mLastX[i] = mLastX[last];
+		mLastY[i] = mLastY[last];
+		mLastZ[i] = mLastZ[last];
+		mVelX[i] = mVelX[last];
+		mVelY[i] = mVelY[last];
+		mVelZ[i] = mVelZ[last];
+		mLife[i] = mLife[last];
+		mMass[i] = mMass[last];
+		mOwner[i] = mOwner[last];
+	}
+	mCount--;
+}
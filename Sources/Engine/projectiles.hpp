@@ -0,0 +1,137 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#ifndef __PROJECTILES_H_
+#define __PROJECTILES_H_
+
+#include "Engine/Rendering/renderer.hpp"
+#include "Engine/bulletphysics.hpp"
+#include "Engine/gametypes.hpp"
+
+
+/*----------------------------------------------
+	Projectile pool
+----------------------------------------------*/
+
+class ProjectileManager
+{
+
+public:
+
+	/**
+	 * @brief Create a fixed-capacity projectile pool
+	 * @param scene			Scene manager
+	 * @param world			Physics world for hit tests
+	 * @param capacity		Maximum number of live projectiles
+	 * @param bRender		Create the billboard batch
+	 **/
+	ProjectileManager(Ogre::SceneManager* scene, btCollisionWorld* world, size_t capacity, bool bRender);
+
+	/**
+	 * @brief Delete the pool
+	 **/
+	~ProjectileManager();
+
+	/**
+	 * @brief Fire a projectile
+	 * @param location		Start position
+	 * @param velocity		Linear velocity
+	 * @param lifeTime		Time before expiration in seconds
+	 * @param mass			Mass used for the impact impulse
+	 * @param owner			Body that will never be hit (shooter), or NULL
+	 * @return false if the pool is full
+	 **/
+	bool spawn(Vector3 location, Vector3 velocity, Real lifeTime, Real mass, const btCollisionObject* owner);
+
+	/**
+	 * @brief Simulation step : move, hit test and expire all projectiles
+	 * @param dt			Step duration
+	 **/
+	void tick(Real dt);
+
+	/**
+	 * @brief Update the billboard batch
+	 * @param alpha			Fraction of a step since the last one (0 - 1)
+	 **/
+	void render(Real alpha);
+
+	/**
+	 * @brief Move all projectiles after a world origin change
+	 * @param shift			Offset to add to all positions
+	 **/
+	void rebase(Vector3 shift);
+
+	/**
+	 * @brief Get the live projectile count
+	 * @return the count
+	 **/
+	size_t getCount();
+
+	/**
+	 * @brief Get the number of projectiles that hit something
+	 * @return the total hit count
+	 **/
+	unsigned long getHitCount();
+
+	/**
+	 * @brief Get the number of projectiles fired
+	 * @return the total spawn count
+	 **/
+	unsigned long getSpawnCount();
+
+
+protected:
+
+	/**
+	 * @brief Batched integration kernel over the SoA arrays
+	 * @param dt			Step duration
+	 **/
+	void integrate(Real dt);
+
+	/**
+	 * @brief Ray test every projectile from its last to its current position
+	 **/
+	void sweep();
+
+	/**
+	 * @brief Remove a projectile by moving the last one in its place
+	 * @param i				Projectile index
+	 **/
+	void kill(size_t i);
+
+
+protected:
+
+	// Pool data
+	size_t mCount;
+	size_t mCapacity;
+	unsigned long mHitCount;
+	unsigned long mSpawnCount;
+
+	// Projectiles (SoA)
+	Ogre::vector<Real>::type mPosX;
+	Ogre::vector<Real>::type mPosY;
+	Ogre::vector<Real>::type mPosZ;
+	Ogre::vector<Real>::type mLastX;
+	Ogre::vector<Real>::type mLastY;
+	Ogre::vector<Real>::type mLastZ;
+	Ogre::vector<Real>::type mVelX;
+	Ogre::vector<Real>::type mVelY;
+	Ogre::vector<Real>::type mVelZ;
+	Ogre::vector<Real>::type mLife;
+	Ogre::vector<Real>::type mMass;
+	Ogre::vector<const btCollisionObject*>::type mOwner;
+
+	// External data
+	btCollisionWorld* mWorld;
+	Ogre::SceneNode* mNode;
+	Ogre::SceneManager* mScene;
+	Ogre::BillboardSet* mBillboards;
+
+};
+
+#endif /* __PROJECTILES_H_ */
@@ -15,10 +15,8 @@
 const Ogre::String XML_FILE_DIR = "Content/Save/0000/";
 const Ogre::String XML_TEMPLATE_DIR = "Content/Templates/";
 
-const char* XML_FILE_VALUE_NAME = "value";
 const char* XML_FILE_SAVE_NAME = "savefile";
 const char* XML_FILE_TEMPLATE_NAME = "template";
-const char* XML_FILE_HEADER = "xml version=\"1.0\" encoding=\"UTF-8\"";
 
 const Quaternion LEFT =			Quaternion(Radian(Degree(-90).valueRadians()), Vector3(0,1,0));
 const Quaternion RIGHT =		Quaternion(Radian(Degree(+90).valueRadians()), Vector3(0,1,0));
@@ -28,6 +26,17 @@ const Quaternion FORWARD =		Quaternion(Radian(Degree(180).valueRadians()), Vecto
 const Quaternion BACK =			Quaternion(Radian(Degree(  0).valueRadians()), Vector3(0,1,0));
 
 
+/*----------------------------------------------
+	Constructor
+----------------------------------------------*/
+
+Savable::Savable()
+{
+	mIsSaving = false;
+	mArchive = NULL;
+}
+
+
 /*----------------------------------------------
 	Public methods (save)
 ----------------------------------------------*/
@@ -39,35 +48,17 @@ void Savable::saveToFile()
 		return;
 	}
 	
+	// One object at the root of the file
+	XmlSaveArchive archive(XML_FILE_SAVE_NAME);
 	mIsSaving = true;
-	mSaveFile = new tinyxml2::XMLDocument();
-
-	if (mSaveFile)
-	{
-		mSaveFile->InsertEndChild(mSaveFile->NewDeclaration(XML_FILE_HEADER));
-		mSaveData = mSaveFile->NewElement(XML_FILE_SAVE_NAME);
-
-		if (mSaveData)
-		{
-			Ogre::String filePath = XML_FILE_DIR + getFileName();
-			mSaveFile->InsertEndChild(mSaveData);
-			save();
-
-			bool res = (mSaveFile->SaveFile(filePath.c_str()) == tinyxml2::XML_NO_ERROR);
-			assert(res && "Failed to save file");
-		}
-		else
-		{
-			assert(false && "Failed to insert save data");
-		}
-		delete mSaveFile;
-	}
-	else
-	{	
-		assert(false && "Failed to create a save file");
-	}
-
+	mArchive = &archive;
+	archive.beginObject("");
+	save();
+	mArchive = NULL;
 	mIsSaving = false;
+
+	bool res = archive.writeFile(XML_FILE_DIR + getFileName(), false);
+	assert(res && "Failed to save file");
 }
 
 
@@ -75,11 +66,13 @@ void Savable::loadFromFile()
 {
 	if (!mIsSaving)
 	{
-		mSaveFile = new tinyxml2::XMLDocument();
-		if (mSaveFile->LoadFile((XML_FILE_DIR + getFileName()).c_str()) == tinyxml2::XML_NO_ERROR)
+		XmlSaveArchive archive(XML_FILE_SAVE_NAME);
+		if (archive.readFile(XML_FILE_DIR + getFileName()))
 		{
-			mSaveData = mSaveFile->FirstChildElement(XML_FILE_SAVE_NAME);
+			archive.openObject("");
+			mArchive = &archive;
 			load();
+			mArchive = NULL;
 		}
 		else
 		{	
@@ -93,21 +86,53 @@ void Savable::loadFromFile()
 }
 
 
+bool Savable::saveTo(SaveArchive* archive)
+{
+	if (!isSavable())
+	{
+		return false;
+	}
+
+	mIsSaving = true;
+	mArchive = archive;
+	mArchive->beginObject(getFileName());
+	save();
+	mArchive = NULL;
+	mIsSaving = false;
+	return true;
+}
+
+
+bool Savable::loadFrom(SaveArchive* archive)
+{
+	if (mIsSaving || !archive->openObject(getFileName()))
+	{
+		return false;
+	}
+	mArchive = archive;
+	load();
+	mArchive = NULL;
+	return true;
+}
+
+
 /*----------------------------------------------
 	Protected methods (templates)
 ----------------------------------------------*/
 
 void Savable::loadTemplate(String name)
 {
+	XmlSaveArchive* archive = new XmlSaveArchive(XML_FILE_TEMPLATE_NAME);
 	mIsSaving = false;
-	mSaveFile = new tinyxml2::XMLDocument();
 
-	if (mSaveFile->LoadFile((XML_TEMPLATE_DIR + name).c_str()) == tinyxml2::XML_NO_ERROR)
+	if (archive->readFile(XML_TEMPLATE_DIR + name))
 	{
-		mSaveData = mSaveFile->FirstChildElement(XML_FILE_TEMPLATE_NAME);
+		archive->openObject("");
+		mArchive = archive;
 	}
 	else
 	{	
+		delete archive;
 		assert(false && "Failed to load template");
 	}
 }
@@ -115,7 +140,8 @@ void Savable::loadTemplate(String name)
 
 void Savable::closeTemplate()
 {
-	delete mSaveFile;
+	delete mArchive;
+	mArchive = NULL;
 }
 
 
@@ -133,12 +159,11 @@ void Savable::setSaveGroup(String name)
 {
 	if (mIsSaving)
 	{
-		mSaveGroup = mSaveFile->NewElement(name.c_str());
-		mSaveData->InsertEndChild(mSaveGroup);
+		mArchive->beginGroup(name);
 	}
 	else
 	{
-		mSaveGroup = mSaveData->FirstChildElement(name.c_str());
+		mArchive->openGroup(name);
 	}
 }
 
@@ -149,28 +174,24 @@ bool Savable::isSavable()
 }
 
 
+/*----------------------------------------------
+	Data save & load
+----------------------------------------------*/
+
 void Savable::saveValue(int value, String name)
 {
 	if (mIsSaving)
 	{
-		tinyxml2::XMLElement* attr = mSaveFile->NewElement(name.c_str());
-		attr->SetAttribute(XML_FILE_VALUE_NAME, value);
-		mSaveGroup->InsertEndChild(attr);
+		mArchive->write(name, value);
 	}
 }
 
 
-/*----------------------------------------------
-	Data save & load
-----------------------------------------------*/
-
 void Savable::saveValue(float value, String name)
 {
 	if (mIsSaving)
 	{
-		tinyxml2::XMLElement* attr = mSaveFile->NewElement(name.c_str());
-		attr->SetAttribute(XML_FILE_VALUE_NAME, value);
-		mSaveGroup->InsertEndChild(attr);
+		mArchive->write(name, value);
 	}
 }
 
@@ -179,9 +200,7 @@ void Savable::saveValue(String value, String name)
 {
 	if (mIsSaving)
 	{
-		tinyxml2::XMLElement* attr = mSaveFile->NewElement(name.c_str());
-		attr->SetAttribute(XML_FILE_VALUE_NAME, value.c_str());
-		mSaveGroup->InsertEndChild(attr);
+		mArchive->write(name, value);
 	}
 }
 
@@ -190,9 +209,7 @@ void Savable::saveValue(Vector3 value, String name)
 {
 	if (mIsSaving)
 	{
-		tinyxml2::XMLElement* attr = mSaveFile->NewElement(name.c_str());
-		attr->SetAttribute(XML_FILE_VALUE_NAME, StringConverter::toString(value).c_str());
-		mSaveGroup->InsertEndChild(attr);
+		mArchive->write(name, value);
 	}
 }
 
@@ -201,9 +218,7 @@ void Savable::saveValue(Quaternion value, String name)
 {
 	if (mIsSaving)
 	{
-		tinyxml2::XMLElement* attr = mSaveFile->NewElement(name.c_str());
-		attr->SetAttribute(XML_FILE_VALUE_NAME, StringConverter::toString(value).c_str());
-		mSaveGroup->InsertEndChild(attr);
+		mArchive->write(name, value);
 	}
 }
 
@@ -212,9 +227,7 @@ void Savable::saveValue(Ogre::ColourValue value, String name)
 {
 	if (mIsSaving)
 	{
-		tinyxml2::XMLElement* attr = mSaveFile->NewElement(name.c_str());
-		attr->SetAttribute(XML_FILE_VALUE_NAME, StringConverter::toString(value).c_str());
-		mSaveGroup->InsertEndChild(attr);
+		mArchive->write(name, value);
 	}
 }
 
@@ -222,11 +235,7 @@ void Savable::saveValue(Ogre::ColourValue value, String name)
 int Savable::loadIntValue(String name)
 {
 	int value = 0;
-	tinyxml2::XMLElement* attr = mSaveGroup->FirstChildElement(name.c_str());
-	if (attr)
-	{
-		value = attr->IntAttribute(XML_FILE_VALUE_NAME);
-	}
+	mArchive->read(name, value);
 	return value;
 }
 
@@ -234,11 +243,7 @@ int Savable::loadIntValue(String name)
 float Savable::loadFloatValue(String name)
 {
 	float value = 0.0f;
-	tinyxml2::XMLElement* attr = mSaveGroup->FirstChildElement(name.c_str());
-	if (attr)
-	{
-		value = attr->FloatAttribute(XML_FILE_VALUE_NAME);
-	}
+	mArchive->read(name, value);
 	return value;
 }
 
@@ -246,35 +251,23 @@ float Savable::loadFloatValue(String name)
 String Savable::loadStringValue(String name)
 {
 	String value;
-	tinyxml2::XMLElement* attr = mSaveGroup->FirstChildElement(name.c_str());
-	if (attr)
-	{
-		value = String(attr->Attribute(XML_FILE_VALUE_NAME));
-	}
+	mArchive->read(name, value);
 	return value;
 }
 
 
 Vector3 Savable::loadVectorValue(String name)
 {
-	Vector3 value;
-	tinyxml2::XMLElement* attr = mSaveGroup->FirstChildElement(name.c_str());
-	if (attr)
-	{
-		value = Ogre::StringConverter::parseVector3(attr->Attribute(XML_FILE_VALUE_NAME));
-	}
+	Vector3 value = Vector3::ZERO;
+	mArchive->read(name, value);
 	return value;
 }
 
 
 Quaternion Savable::loadQuaternionValue(String name)
 {
-	Quaternion value;
-	tinyxml2::XMLElement* attr = mSaveGroup->FirstChildElement(name.c_str());
-	if (attr)
-	{
-		value = Ogre::StringConverter::parseQuaternion(attr->Attribute(XML_FILE_VALUE_NAME));
-	}
+	Quaternion value = Quaternion::IDENTITY;
+	mArchive->read(name, value);
 	return value;
 }
 
@@ -282,11 +275,7 @@ Quaternion Savable::loadQuaternionValue(String name)
 Ogre::ColourValue Savable::loadColourValue(String name)
 {
 	Ogre::ColourValue value;
-	tinyxml2::XMLElement* attr = mSaveGroup->FirstChildElement(name.c_str());
-	if (attr)
-	{
-		value = Ogre::StringConverter::parseColourValue(attr->Attribute(XML_FILE_VALUE_NAME));
-	}
+	mArchive->read(name, value);
 	return value;
 }
 
@@ -10,6 +10,7 @@
 
 #include "tinyxml2.hpp"
 #include "Engine/game.hpp"
+#include "Engine/savearchive.hpp"
 
 
 /*----------------------------------------------
@@ -21,6 +22,11 @@ class Savable
 
 public:
 	
+	/**
+	 * @brief Create a savable object
+	 **/
+	Savable();
+	
 	/**
 	 * @brief Save the entire instance by dumping it to a XML file
 	 * @return true if successful
@@ -32,6 +38,27 @@ public:
 	 * @return true if successful
 	 **/
 	void loadFromFile();
+	
+	/**
+	 * @brief Save the instance as one object of a shared archive
+	 * @param archive		Save backend
+	 * @return false if this class is not savable
+	 **/
+	bool saveTo(SaveArchive* archive);
+	
+	/**
+	 * @brief Load the instance from a shared archive
+	 * @param archive		Save backend
+	 * @return false if this instance was not found
+	 **/
+	bool loadFrom(SaveArchive* archive);
+	
+	/**
+	 * @brief Parse a string into a quaternion
+	 * @param quat			Input string : LEFT, RIGHT, TOP, BOTTOM, FORWARD or a quaternion
+	 * @return the Ogre quaternion
+	 **/
+	static Quaternion directionFromString(Ogre::String quat);
 
 
 protected:
@@ -166,22 +193,13 @@ protected:
 	 * @return the value
 	 **/
 	Ogre::ColourValue loadColourValue(String name);
-	
-	/**
-	 * @brief Parse a string into a quaternion
-	 * @param vec			Input string
-	 * @return the Ogre quaternion
-	 **/
-	Quaternion directionFromString(Ogre::String quat);
 
 
 protected:
 
 	// Save data
 	bool mIsSaving;
-	tinyxml2::XMLDocument* mSaveFile;
-	tinyxml2::XMLElement* mSaveData;
-	tinyxml2::XMLElement* mSaveGroup;
+	SaveArchive* mArchive;
 
 };
 
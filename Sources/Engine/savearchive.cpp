@@ -0,0 +1,725 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#include "Engine/savearchive.hpp"
+
+#if OGRE_NO_ZIP_ARCHIVE == 0
+#	include "OgreDeflate.h"
+#endif
+
+
+/*----------------------------------------------
+	Definitions
+----------------------------------------------*/
+
+const char* XML_SAVE_HEADER = "xml version=\"1.0\" encoding=\"UTF-8\"";
+const char* XML_SAVE_OBJECT = "object";
+const char* XML_SAVE_OBJECT_NAME = "name";
+const char* XML_SAVE_VALUE = "value";
+
+const Ogre::uint32 BINARY_SAVE_MAGIC = 0x56535953; // "SYSV"
+const Ogre::uint32 BINARY_SAVE_VERSION = 1;
+const Ogre::uint32 BINARY_SAVE_COMPRESSED = 0x1;
+const size_t BINARY_SAVE_HEADER_SIZE = 6 * sizeof(Ogre::uint32);
+const size_t INVALID_OFFSET = (size_t)-1;
+
+// Binary records : tag (uint8), then name (uint16 key, or string for objects), then value
+enum BinaryTag
+{
+	BT_OBJECT = 1,
+	BT_GROUP,
+	BT_INT,
+	BT_FLOAT,
+	BT_STRING,
+	BT_VECTOR,
+	BT_QUATERNION,
+	BT_COLOUR
+};
+
+
+/*----------------------------------------------
+	XML backend
+----------------------------------------------*/
+
+XmlSaveArchive::XmlSaveArchive(String rootName)
+	: mRootName(rootName)
+{
+	mDocument = new tinyxml2::XMLDocument();
+	mRoot = NULL;
+	mObject = NULL;
+	mGroup = NULL;
+}
+
+
+XmlSaveArchive::~XmlSaveArchive()
+{
+	delete mDocument;
+}
+
+
+bool XmlSaveArchive::writeFile(String path, bool bCompress)
+{
+	return (mDocument->SaveFile(path.c_str()) == tinyxml2::XML_NO_ERROR);
+}
+
+
+bool XmlSaveArchive::readFile(String path)
+{
+	mObjects.clear();
+	mObject = NULL;
+	mGroup = NULL;
+	if (mDocument->LoadFile(path.c_str()) != tinyxml2::XML_NO_ERROR)
+	{
+		mRoot = NULL;
+		return false;
+	}
+	mRoot = mDocument->FirstChildElement(mRootName.c_str());
+
+	// Index objects
+	tinyxml2::XMLElement* i = mRoot ? mRoot->FirstChildElement(XML_SAVE_OBJECT) : NULL;
+	while (i != NULL)
+	{
+		const char* name = i->Attribute(XML_SAVE_OBJECT_NAME);
+		if (name)
+		{
+			mObjects[name] = i;
+		}
+		i = i->NextSiblingElement(XML_SAVE_OBJECT);
+	}
+	return (mRoot != NULL);
+}
+
+
+size_t XmlSaveArchive::getObjectCount()
+{
+	return mObjects.size();
+}
+
+
+void XmlSaveArchive::beginObject(String name)
+{
+	if (!mRoot)
+	{
+		mDocument->InsertEndChild(mDocument->NewDeclaration(XML_SAVE_HEADER));
+		mRoot = mDocument->NewElement(mRootName.c_str());
+		mDocument->InsertEndChild(mRoot);
+	}
+
+	if (name.length() > 0)
+	{
+		mObject = mDocument->NewElement(XML_SAVE_OBJECT);
+		mObject->SetAttribute(XML_SAVE_OBJECT_NAME, name.c_str());
+		mRoot->InsertEndChild(mObject);
+		mObjects[name] = mObject;
+	}
+	else
+	{
+		mObject = mRoot;
+	}
+	mGroup = NULL;
+}
+
+
+bool XmlSaveArchive::openObject(String name)
+{
+	mGroup = NULL;
+	if (name.length() == 0)
+	{
+		mObject = mRoot;
+	}
+	else
+	{
+		Ogre::map<String, tinyxml2::XMLElement*>::type::iterator it = mObjects.find(name);
+		mObject = (it != mObjects.end()) ? it->second : NULL;
+	}
+	return (mObject != NULL);
+}
+
+
+void XmlSaveArchive::beginGroup(String name)
+{
+	mGroup = mDocument->NewElement(name.c_str());
+	mObject->InsertEndChild(mGroup);
+}
+
+
+bool XmlSaveArchive::openGroup(String name)
+{
+	mGroup = mObject ? mObject->FirstChildElement(name.c_str()) : NULL;
+	return (mGroup != NULL);
+}
+
+
+void XmlSaveArchive::write(String name, int value)
+{
+	writeText(name, StringConverter::toString(value).c_str());
+}
+
+
+void XmlSaveArchive::write(String name, float value)
+{
+	writeText(name, StringConverter::toString(value).c_str());
+}
+
+
+void XmlSaveArchive::write(String name, String value)
+{
+	writeText(name, value.c_str());
+}
+
+
+void XmlSaveArchive::write(String name, Vector3 value)
+{
+	writeText(name, StringConverter::toString(value).c_str());
+}
+
+
+void XmlSaveArchive::write(String name, Quaternion value)
+{
+	writeText(name, StringConverter::toString(value).c_str());
+}
+
+
+void XmlSaveArchive::write(String name, Ogre::ColourValue value)
+{
+	writeText(name, StringConverter::toString(value).c_str());
+}
+
+
+bool XmlSaveArchive::read(String name, int& value)
+{
+	const char* text = readText(name);
+	if (text)
+	{
+		value = StringConverter::parseInt(text);
+	}
+	return (text != NULL);
+}
+
+
+bool XmlSaveArchive::read(String name, float& value)
+{
+	const char* text = readText(name);
+	if (text)
+	{
+		value = StringConverter::parseReal(text);
+	}
+	return (text != NULL);
+}
+
+
+bool XmlSaveArchive::read(String name, String& value)
+{
+	const char* text = readText(name);
+	if (text)
+	{
+		value = String(text);
+	}
+	return (text != NULL);
+}
+
+
+bool XmlSaveArchive::read(String name, Vector3& value)
+{
+	const char* text = readText(name);
+	if (text)
+	{
+		value = StringConverter::parseVector3(text);
+	}
+	return (text != NULL);
+}
+
+
+bool XmlSaveArchive::read(String name, Quaternion& value)
+{
+	const char* text = readText(name);
+	if (text)
+	{
+		value = StringConverter::parseQuaternion(text);
+	}
+	return (text != NULL);
+}
+
+
+bool XmlSaveArchive::read(String name, Ogre::ColourValue& value)
+{
+	const char* text = readText(name);
+	if (text)
+	{
+		value = StringConverter::parseColourValue(text);
+	}
+	return (text != NULL);
+}
+
+
+void XmlSaveArchive::writeText(String name, const char* value)
+{
+	tinyxml2::XMLElement* attr = mDocument->NewElement(name.c_str());
+	attr->SetAttribute(XML_SAVE_VALUE, value);
+	mGroup->InsertEndChild(attr);
+}
+
+
+const char* XmlSaveArchive::readText(String name)
+{
+	tinyxml2::XMLElement* attr = mGroup ? mGroup->FirstChildElement(name.c_str()) : NULL;
+	return attr ? attr->Attribute(XML_SAVE_VALUE) : NULL;
+}
+
+
+/*----------------------------------------------
+	Binary backend
+----------------------------------------------*/
+
+BinarySaveArchive::BinarySaveArchive()
+{
+	mObjectCount = 0;
+	mObjectOffset = INVALID_OFFSET;
+	mGroupOffset = INVALID_OFFSET;
+}
+
+
+bool BinarySaveArchive::writeFile(String path, bool bCompress)
+{
+	Ogre::vector<unsigned char>::type data;
+	Ogre::uint32 header[6] = {
+		BINARY_SAVE_MAGIC,
+		BINARY_SAVE_VERSION,
+		bCompress ? BINARY_SAVE_COMPRESSED : 0,
+		mObjectCount,
+		(Ogre::uint32)mKeys.size(),
+		(Ogre::uint32)mPayload.size()};
+
+	// Whole file in memory : header, key table, payload
+	data.insert(data.end(), (unsigned char*)header, (unsigned char*)header + sizeof(header));
+	for (size_t i = 0; i < mKeys.size(); i++)
+	{
+		Ogre::uint16 length = (Ogre::uint16)mKeys[i].length();
+		data.insert(data.end(), (unsigned char*)&length, (unsigned char*)&length + sizeof(length));
+		data.insert(data.end(), mKeys[i].begin(), mKeys[i].end());
+	}
+	data.insert(data.end(), mPayload.begin(), mPayload.end());
+
+	// Single write
+	std::fstream* file = OGRE_NEW_T(std::fstream, Ogre::MEMCATEGORY_GENERAL)(
+		path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file->is_open())
+	{
+		OGRE_DELETE_T(file, basic_fstream, Ogre::MEMCATEGORY_GENERAL);
+		return false;
+	}
+	Ogre::DataStreamPtr stream(OGRE_NEW Ogre::FileStreamDataStream(file, false));
+	size_t written = 0;
+#if OGRE_NO_ZIP_ARCHIVE == 0
+	if (bCompress)
+	{
+		// Compression errors are thrown when the deflate stream is finished
+		try
+		{
+			Ogre::DeflateStream deflate(stream);
+			written = deflate.write(&data[0], data.size());
+			deflate.close();
+		}
+		catch (Ogre::Exception&)
+		{
+			written = 0;
+		}
+	}
+	else
+#endif
+	{
+		written = stream->write(&data[0], data.size());
+	}
+
+	// The file is still ours after the stream is closed, so that a failed flush is seen
+	stream->close();
+	bool bWritten = (written == data.size() && !file->fail());
+	OGRE_DELETE_T(file, basic_fstream, Ogre::MEMCATEGORY_GENERAL);
+	return bWritten;
+}
+
+
+bool BinarySaveArchive::readFile(String path)
+{
+	Ogre::vector<unsigned char>::type data;
+	mPayload.clear();
+	mKeys.clear();
+	mKeyIds.clear();
+	mObjects.clear();
+	mObjectCount = 0;
+	mObjectOffset = INVALID_OFFSET;
+	mGroupOffset = INVALID_OFFSET;
+
+	// Read the whole file, inflating it if it doesn't start with the header
+	std::ifstream* file = OGRE_NEW_T(std::ifstream, Ogre::MEMCATEGORY_GENERAL)(path.c_str(), std::ios::in | std::ios::binary);
+	if (!file->is_open())
+	{
+		OGRE_DELETE_T(file, basic_ifstream, Ogre::MEMCATEGORY_GENERAL);
+		return false;
+	}
+	Ogre::DataStreamPtr stream(OGRE_NEW Ogre::FileStreamDataStream(file, true));
+	Ogre::uint32 magic = 0;
+	stream->read(&magic, sizeof(magic));
+	stream->seek(0);
+	if (magic != BINARY_SAVE_MAGIC)
+	{
+#if OGRE_NO_ZIP_ARCHIVE == 0
+		stream = Ogre::DataStreamPtr(OGRE_NEW Ogre::DeflateStream(stream));
+#else
+		return false;
+#endif
+	}
+	unsigned char chunk[16384];
+	size_t count;
+	while ((count = stream->read(chunk, sizeof(chunk))) > 0)
+	{
+		data.insert(data.end(), chunk, chunk + count);
+	}
+	stream->close();
+
+	// Header
+	if (data.size() < BINARY_SAVE_HEADER_SIZE)
+	{
+		return false;
+	}
+	Ogre::uint32 header[6];
+	memcpy(header, &data[0], sizeof(header));
+	if (header[0] != BINARY_SAVE_MAGIC || header[1] != BINARY_SAVE_VERSION)
+	{
+		return false;
+	}
+
+	// Key table
+	size_t offset = BINARY_SAVE_HEADER_SIZE;
+	for (Ogre::uint32 i = 0; i < header[4]; i++)
+	{
+		Ogre::uint16 length;
+		if (offset + sizeof(length) > data.size())
+		{
+			return false;
+		}
+		memcpy(&length, &data[offset], sizeof(length));
+		offset += sizeof(length);
+		if (offset + length > data.size())
+		{
+			return false;
+		}
+		String key((const char*)&data[offset], length);
+		mKeyIds[key] = (Ogre::uint16)mKeys.size();
+		mKeys.push_back(key);
+		offset += length;
+	}
+
+	// Payload
+	if (offset + header[5] != data.size())
+	{
+		return false;
+	}
+	mPayload.assign(data.begin() + offset, data.end());
+
+	// Index objects
+	offset = 0;
+	while (offset < mPayload.size())
+	{
+		size_t size = getRecordSize(offset);
+		if (size == 0)
+		{
+			return false;
+		}
+		if (mPayload[offset] == BT_OBJECT)
+		{
+			Ogre::uint16 length;
+			memcpy(&length, &mPayload[offset + 1], sizeof(length));
+			mObjects[String((const char*)&mPayload[offset + 3], length)] = offset;
+			mObjectCount++;
+		}
+		offset += size;
+	}
+	return (mObjectCount == header[3]);
+}
+
+
+size_t BinarySaveArchive::getObjectCount()
+{
+	return mObjectCount;
+}
+
+
+void BinarySaveArchive::beginObject(String name)
+{
+	Ogre::uint8 tag = BT_OBJECT;
+	Ogre::uint16 length = (Ogre::uint16)name.length();
+	put(&tag, sizeof(tag));
+	put(&length, sizeof(length));
+	put(name.c_str(), length);
+	mObjectCount++;
+}
+
+
+bool BinarySaveArchive::openObject(String name)
+{
+	Ogre::map<String, size_t>::type::iterator it = mObjects.find(name);
+	mObjectOffset = (it != mObjects.end()) ? it->second : INVALID_OFFSET;
+	mGroupOffset = INVALID_OFFSET;
+	return (mObjectOffset != INVALID_OFFSET);
+}
+
+
+void BinarySaveArchive::beginGroup(String name)
+{
+	putRecord(BT_GROUP, name);
+}
+
+
+bool BinarySaveArchive::openGroup(String name)
+{
+	mGroupOffset = INVALID_OFFSET;
+	Ogre::map<String, Ogre::uint16>::type::iterator key = mKeyIds.find(name);
+	if (mObjectOffset == INVALID_OFFSET || key == mKeyIds.end())
+	{
+		return false;
+	}
+
+	// Scan the object's records
+	size_t offset = mObjectOffset + getRecordSize(mObjectOffset);
+	while (offset < mPayload.size() && mPayload[offset] != BT_OBJECT)
+	{
+		Ogre::uint16 id;
+		memcpy(&id, &mPayload[offset + 1], sizeof(id));
+		if (mPayload[offset] == BT_GROUP && id == key->second)
+		{
+			mGroupOffset = offset;
+			return true;
+		}
+		offset += getRecordSize(offset);
+	}
+	return false;
+}
+
+
+void BinarySaveArchive::write(String name, int value)
+{
+	Ogre::int32 data = value;
+	putRecord(BT_INT, name);
+	put(&data, sizeof(data));
+}
+
+
+void BinarySaveArchive::write(String name, float value)
+{
+	putRecord(BT_FLOAT, name);
+	put(&value, sizeof(value));
+}
+
+
+void BinarySaveArchive::write(String name, String value)
+{
+	Ogre::uint16 length = (Ogre::uint16)value.length();
+	putRecord(BT_STRING, name);
+	put(&length, sizeof(length));
+	put(value.c_str(), length);
+}
+
+
+void BinarySaveArchive::write(String name, Vector3 value)
+{
+	float data[3] = {value.x, value.y, value.z};
+	putRecord(BT_VECTOR, name);
+	put(data, sizeof(data));
+}
+
+
+void BinarySaveArchive::write(String name, Quaternion value)
+{
+	float data[4] = {value.w, value.x, value.y, value.z};
+	putRecord(BT_QUATERNION, name);
+	put(data, sizeof(data));
+}
+
+
+void BinarySaveArchive::write(String name, Ogre::ColourValue value)
+{
+	float data[4] = {value.r, value.g, value.b, value.a};
+	putRecord(BT_COLOUR, name);
+	put(data, sizeof(data));
+}
+
+
+bool BinarySaveArchive::read(String name, int& value)
+{
+	const unsigned char* data = find(BT_INT, name);
+	if (data)
+	{
+		Ogre::int32 result;
+		memcpy(&result, data, sizeof(result));
+		value = result;
+	}
+	return (data != NULL);
+}
+
+
+bool BinarySaveArchive::read(String name, float& value)
+{
+	const unsigned char* data = find(BT_FLOAT, name);
+	if (data)
+	{
+		memcpy(&value, data, sizeof(value));
+	}
+	return (data != NULL);
+}
+
+
+bool BinarySaveArchive::read(String name, String& value)
+{
+	const unsigned char* data = find(BT_STRING, name);
+	if (data)
+	{
+		Ogre::uint16 length;
+		memcpy(&length, data, sizeof(length));
+		value = String((const char*)data + sizeof(length), length);
+	}
+	return (data != NULL);
+}
+
+
+bool BinarySaveArchive::read(String name, Vector3& value)
+{
+	const unsigned char* data = find(BT_VECTOR, name);
+	if (data)
+	{
+		float result[3];
+		memcpy(result, data, sizeof(result));
+		value = Vector3(result[0], result[1], result[2]);
+	}
+	return (data != NULL);
+}
+
+
+bool BinarySaveArchive::read(String name, Quaternion& value)
+{
+	const unsigned char* data = find(BT_QUATERNION, name);
+	if (data)
+	{
+		float result[4];
+		memcpy(result, data, sizeof(result));
+		value = Quaternion(result[0], result[1], result[2], result[3]);
+	}
+	return (data != NULL);
+}
+
+
+bool BinarySaveArchive::read(String name, Ogre::ColourValue& value)
+{
+	const unsigned char* data = find(BT_COLOUR, name);
+	if (data)
+	{
+		float result[4];
+		memcpy(result, data, sizeof(result));
+		value = Ogre::ColourValue(result[0], result[1], result[2], result[3]);
+	}
+	return (data != NULL);
+}
+
+
+void BinarySaveArchive::put(const void* data, size_t size)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	mPayload.insert(mPayload.end(), bytes, bytes + size);
+}
+
+
+void BinarySaveArchive::putRecord(Ogre::uint8 tag, String name)
+{
+	Ogre::uint16 id;
+
+	// Intern the name
+	Ogre::map<String, Ogre::uint16>::type::iterator it = mKeyIds.find(name);
+	if (it == mKeyIds.end())
+	{
+		id = (Ogre::uint16)mKeys.size();
+		mKeyIds[name] = id;
+		mKeys.push_back(name);
+	}
+	else
+	{
+		id = it->second;
+	}
+
+	put(&tag, sizeof(tag));
+	put(&id, sizeof(id));
+}
+
+
+const unsigned char* BinarySaveArchive::find(Ogre::uint8 tag, String name)
+{
+	Ogre::map<String, Ogre::uint16>::type::iterator key = mKeyIds.find(name);
+	if (mGroupOffset == INVALID_OFFSET || key == mKeyIds.end())
+	{
+		return NULL;
+	}
+
+	// Scan the group's records
+	size_t offset = mGroupOffset + getRecordSize(mGroupOffset);
+	while (offset < mPayload.size() && mPayload[offset] != BT_OBJECT && mPayload[offset] != BT_GROUP)
+	{
+		Ogre::uint16 id;
+		memcpy(&id, &mPayload[offset + 1], sizeof(id));
+		if (mPayload[offset] == tag && id == key->second)
+		{
+			return &mPayload[offset + 1 + sizeof(id)];
+		}
+		offset += getRecordSize(offset);
+	}
+	return NULL;
+}
+
+
+size_t BinarySaveArchive::getRecordSize(size_t offset)
+{
+	size_t header = 1 + sizeof(Ogre::uint16);
+	size_t size = 0;
+	if (offset + header > mPayload.size())
+	{
+		return 0;
+	}
+
+	switch (mPayload[offset])
+	{
+		case BT_OBJECT:
+		case BT_STRING:
+		{
+			// Length-prefixed string, after the key for values
+			size_t lengthOffset = (mPayload[offset] == BT_OBJECT) ? 1 : header;
+			Ogre::uint16 length;
+			if (offset + lengthOffset + sizeof(length) > mPayload.size())
+			{
+				return 0;
+			}
+			memcpy(&length, &mPayload[offset + lengthOffset], sizeof(length));
+			size = lengthOffset + sizeof(length) + length;
+			break;
+		}
+		case BT_GROUP:
+			size = header;
+			break;
+		case BT_INT:
+		case BT_FLOAT:
+			size = header + 4;
+			break;
+		case BT_VECTOR:
+			size = header + 12;
+			break;
+		case BT_QUATERNION:
+		case BT_COLOUR:
+			size = header + 16;
+			break;
+		default:
+			return 0;
+	}
+
+	return (offset + size <= mPayload.size()) ? size : 0;
+}
@@ -0,0 +1,262 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#ifndef __SAVE_ARCHIVE_H_
+#define __SAVE_ARCHIVE_H_
+
+#include "tinyxml2.hpp"
+#include "Engine/Rendering/renderer.hpp"
+#include "Engine/gametypes.hpp"
+
+
+/*----------------------------------------------
+	Save backend interface
+----------------------------------------------*/
+
+class SaveArchive
+{
+
+public:
+
+	virtual ~SaveArchive() {}
+
+	/**
+	 * @brief Write the archive to disk in one go
+	 * @param path			File path
+	 * @param bCompress		Compress the file if the backend supports it
+	 * @return true if successful
+	 **/
+	virtual bool writeFile(String path, bool bCompress) = 0;
+
+	/**
+	 * @brief Read a whole archive from disk
+	 * @param path			File path
+	 * @return true if successful
+	 **/
+	virtual bool readFile(String path) = 0;
+
+	/**
+	 * @brief Get the number of saved objects
+	 * @return the object count
+	 **/
+	virtual size_t getObjectCount() = 0;
+
+	/**
+	 * @brief Start writing a new object
+	 * @param name			Unique object name, empty for the root of a single-object archive
+	 **/
+	virtual void beginObject(String name) = 0;
+
+	/**
+	 * @brief Select an object to read
+	 * @param name			Object name
+	 * @return false if the object was not saved
+	 **/
+	virtual bool openObject(String name) = 0;
+
+	/**
+	 * @brief Start writing a group in the current object
+	 * @param name			Group name
+	 **/
+	virtual void beginGroup(String name) = 0;
+
+	/**
+	 * @brief Select a group to read in the current object
+	 * @param name			Group name
+	 * @return false if the group was not saved
+	 **/
+	virtual bool openGroup(String name) = 0;
+
+	/**
+	 * @brief Write a value in the current group
+	 * @param name			Value name
+	 * @param value			Value
+	 **/
+	virtual void write(String name, int value) = 0;
+	virtual void write(String name, float value) = 0;
+	virtual void write(String name, String value) = 0;
+	virtual void write(String name, Vector3 value) = 0;
+	virtual void write(String name, Quaternion value) = 0;
+	virtual void write(String name, Ogre::ColourValue value) = 0;
+
+	/**
+	 * @brief Read a value from the current group
+	 * @param name			Value name
+	 * @param value			Output value, unchanged if missing
+	 * @return false if the value was not saved
+	 **/
+	virtual bool read(String name, int& value) = 0;
+	virtual bool read(String name, float& value) = 0;
+	virtual bool read(String name, String& value) = 0;
+	virtual bool read(String name, Vector3& value) = 0;
+	virtual bool read(String name, Quaternion& value) = 0;
+	virtual bool read(String name, Ogre::ColourValue& value) = 0;
+
+};
+
+
+/*----------------------------------------------
+	XML backend
+----------------------------------------------*/
+
+class XmlSaveArchive : public SaveArchive
+{
+
+public:
+
+	/**
+	 * @brief Create an empty XML archive
+	 * @param rootName		Name of the document element
+	 **/
+	XmlSaveArchive(String rootName);
+
+	~XmlSaveArchive();
+
+	bool writeFile(String path, bool bCompress);
+	bool readFile(String path);
+	size_t getObjectCount();
+
+	void beginObject(String name);
+	bool openObject(String name);
+	void beginGroup(String name);
+	bool openGroup(String name);
+
+	void write(String name, int value);
+	void write(String name, float value);
+	void write(String name, String value);
+	void write(String name, Vector3 value);
+	void write(String name, Quaternion value);
+	void write(String name, Ogre::ColourValue value);
+
+	bool read(String name, int& value);
+	bool read(String name, float& value);
+	bool read(String name, String& value);
+	bool read(String name, Vector3& value);
+	bool read(String name, Quaternion& value);
+	bool read(String name, Ogre::ColourValue& value);
+
+
+protected:
+
+	/**
+	 * @brief Add a value element to the current group
+	 * @param name			Value name
+	 * @param value			Value as text
+	 **/
+	void writeText(String name, const char* value);
+
+	/**
+	 * @brief Get a value from the current group
+	 * @param name			Value name
+	 * @return the value as text, or NULL
+	 **/
+	const char* readText(String name);
+
+
+protected:
+
+	// Document
+	String mRootName;
+	tinyxml2::XMLDocument* mDocument;
+	tinyxml2::XMLElement* mRoot;
+	tinyxml2::XMLElement* mObject;
+	tinyxml2::XMLElement* mGroup;
+
+	// Objects by name
+	Ogre::map<String, tinyxml2::XMLElement*>::type mObjects;
+
+};
+
+
+/*----------------------------------------------
+	Binary backend
+----------------------------------------------*/
+
+class BinarySaveArchive : public SaveArchive
+{
+
+public:
+
+	/**
+	 * @brief Create an empty binary archive
+	 **/
+	BinarySaveArchive();
+
+	bool writeFile(String path, bool bCompress);
+	bool readFile(String path);
+	size_t getObjectCount();
+
+	void beginObject(String name);
+	bool openObject(String name);
+	void beginGroup(String name);
+	bool openGroup(String name);
+
+	void write(String name, int value);
+	void write(String name, float value);
+	void write(String name, String value);
+	void write(String name, Vector3 value);
+	void write(String name, Quaternion value);
+	void write(String name, Ogre::ColourValue value);
+
+	bool read(String name, int& value);
+	bool read(String name, float& value);
+	bool read(String name, String& value);
+	bool read(String name, Vector3& value);
+	bool read(String name, Quaternion& value);
+	bool read(String name, Ogre::ColourValue& value);
+
+
+protected:
+
+	/**
+	 * @brief Append raw data to the payload
+	 * @param data			Data
+	 * @param size			Data size
+	 **/
+	void put(const void* data, size_t size);
+
+	/**
+	 * @brief Append a record header : tag, then interned name
+	 * @param tag			Record type
+	 * @param name			Record name
+	 **/
+	void putRecord(Ogre::uint8 tag, String name);
+
+	/**
+	 * @brief Find a value record in the current group
+	 * @param tag			Record type
+	 * @param name			Value name
+	 * @return a pointer to the value, or NULL
+	 **/
+	const unsigned char* find(Ogre::uint8 tag, String name);
+
+	/**
+	 * @brief Get the size of a record
+	 * @param offset		Record offset in the payload
+	 * @return the record size, or 0 if it is invalid
+	 **/
+	size_t getRecordSize(size_t offset);
+
+
+protected:
+
+	// Payload
+	Ogre::vector<unsigned char>::type mPayload;
+	Ogre::uint32 mObjectCount;
+
+	// Interned value and group names
+	Ogre::vector<String>::type mKeys;
+	Ogre::map<String, Ogre::uint16>::type mKeyIds;
+
+	// Read cursors
+	Ogre::map<String, size_t>::type mObjects;
+	size_t mObjectOffset;
+	size_t mGroupOffset;
+
+};
+
+#endif /* __SAVE_ARCHIVE_H_ */
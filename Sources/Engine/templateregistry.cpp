@@ -0,0 +1,157 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#include "Engine/templateregistry.hpp"
+#include "OgreFileSystem.h"
+
+#include <thread>
+
+
+/*----------------------------------------------
+	Definitions
+----------------------------------------------*/
+
+const char* XML_TEMPLATE_ROOT = "template";
+const char* XML_TEMPLATE_VALUE = "value";
+
+
+/*----------------------------------------------
+	Constructor & destructor
+----------------------------------------------*/
+
+TemplateRegistry::TemplateRegistry(String path)
+	: mPath(path)
+{
+}
+
+
+TemplateRegistry::~TemplateRegistry()
+{
+	for (Ogre::map<String, Template*>::type::iterator it = mTemplates.begin(); it != mTemplates.end(); it++)
+	{
+		delete it->second;
+	}
+}
+
+
+/*----------------------------------------------
+	Public methods
+----------------------------------------------*/
+
+void TemplateRegistry::addParser(String folder, TemplateParser parser)
+{
+	mParsers[folder] = parser;
+}
+
+
+void TemplateRegistry::load()
+{
+	Ogre::vector<Job>::type jobs;
+
+	// List the files
+	for (Ogre::map<String, TemplateParser>::type::iterator it = mParsers.begin(); it != mParsers.end(); it++)
+	{
+		Ogre::FileSystemArchive folder(mPath + it->first, "FileSystem", true);
+		folder.load();
+		Ogre::StringVectorPtr files = folder.find("*.xml", false);
+
+		for (Ogre::StringVector::iterator file = files->begin(); file != files->end(); file++)
+		{
+			String base, ext;
+			StringUtil::splitBaseFilename(*file, base, ext);
+			Job job;
+			job.name = it->first + base;
+			job.file = mPath + it->first + *file;
+			job.parser = it->second;
+			job.result = NULL;
+			jobs.push_back(job);
+		}
+		folder.unload();
+	}
+
+	// Parse on all cores, each worker takes the next free job
+	std::atomic<size_t> next(0);
+	size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+	threadCount = std::min(threadCount, jobs.size());
+	Ogre::vector<std::thread*>::type workers;
+	for (size_t i = 0; i < threadCount; i++)
+	{
+		workers.push_back(new std::thread(&TemplateRegistry::parseJobs, &jobs, &next));
+	}
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i]->join();
+		delete workers[i];
+	}
+
+	// Publish
+	for (size_t i = 0; i < jobs.size(); i++)
+	{
+		assert(jobs[i].result != NULL && "Failed to load template");
+		if (jobs[i].result)
+		{
+			delete mTemplates[jobs[i].name];
+			mTemplates[jobs[i].name] = jobs[i].result;
+		}
+	}
+}
+
+
+const Template* TemplateRegistry::get(String name)
+{
+	Ogre::map<String, Template*>::type::iterator it = mTemplates.find(name);
+	if (it == mTemplates.end())
+	{
+		return NULL;
+	}
+	return it->second;
+}
+
+
+int TemplateRegistry::readInt(tinyxml2::XMLElement* group, const char* name)
+{
+	tinyxml2::XMLElement* attr = group ? group->FirstChildElement(name) : NULL;
+	return attr ? attr->IntAttribute(XML_TEMPLATE_VALUE) : 0;
+}
+
+
+float TemplateRegistry::readFloat(tinyxml2::XMLElement* group, const char* name)
+{
+	tinyxml2::XMLElement* attr = group ? group->FirstChildElement(name) : NULL;
+	return attr ? attr->FloatAttribute(XML_TEMPLATE_VALUE) : 0.0f;
+}
+
+
+String TemplateRegistry::readString(tinyxml2::XMLElement* group, const char* name)
+{
+	tinyxml2::XMLElement* attr = group ? group->FirstChildElement(name) : NULL;
+	const char* value = attr ? attr->Attribute(XML_TEMPLATE_VALUE) : NULL;
+	return value ? String(value) : String();
+}
+
+
+/*----------------------------------------------
+	Private methods
+----------------------------------------------*/
+
+void TemplateRegistry::parseJobs(Ogre::vector<Job>::type* jobs, std::atomic<size_t>* next)
+{
+	size_t i;
+	while ((i = (*next)++) < jobs->size())
+	{
+		Job& job = (*jobs)[i];
+		tinyxml2::XMLDocument doc;
+		if (doc.LoadFile(job.file.c_str()) == tinyxml2::XML_NO_ERROR)
+		{
+			tinyxml2::XMLElement* root = doc.FirstChildElement(XML_TEMPLATE_ROOT);
+			if (root)
+			{
+				job.result = job.parser(root);
+			}
+		}
+	}
+}
@@ -0,0 +1,131 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#ifndef __TEMPLATE_REGISTRY_H_
+#define __TEMPLATE_REGISTRY_H_
+
+#include "tinyxml2.hpp"
+#include "Engine/Rendering/renderer.hpp"
+#include "Engine/gametypes.hpp"
+
+#include <atomic>
+
+
+/*----------------------------------------------
+	Parsed template
+----------------------------------------------*/
+
+class Template
+{
+
+public:
+
+	virtual ~Template() {}
+
+};
+
+/**
+ * @brief Template parser : build a template from its XML root, must be thread-safe
+ * @param root			<template> element
+ * @return the new template
+ **/
+typedef Template* (*TemplateParser)(tinyxml2::XMLElement* root);
+
+
+/*----------------------------------------------
+	Template registry
+----------------------------------------------*/
+
+class TemplateRegistry
+{
+
+public:
+
+	/**
+	 * @brief Create an empty registry
+	 * @param path			Template folder
+	 **/
+	TemplateRegistry(String path);
+
+	/**
+	 * @brief Delete all templates
+	 **/
+	~TemplateRegistry();
+
+	/**
+	 * @brief Set the parser used for a template folder
+	 * @param folder		Folder name, relative to the template folder (ex : "Ships/")
+	 * @param parser		Parser function
+	 **/
+	void addParser(String folder, TemplateParser parser);
+
+	/**
+	 * @brief Parse every template of the registered folders, on a worker pool (blocking)
+	 **/
+	void load();
+
+	/**
+	 * @brief Get a parsed template
+	 * @param name			Folder and file name without extension (ex : "Ships/Sovereign")
+	 * @return the template, or NULL
+	 **/
+	const Template* get(String name);
+
+	/**
+	 * @brief Read an integer value (<name value="..." />)
+	 * @param group			Parent element
+	 * @param name			Value name
+	 * @return the value, or 0
+	 **/
+	static int readInt(tinyxml2::XMLElement* group, const char* name);
+
+	/**
+	 * @brief Read a float value (<name value="..." />)
+	 * @param group			Parent element
+	 * @param name			Value name
+	 * @return the value, or 0
+	 **/
+	static float readFloat(tinyxml2::XMLElement* group, const char* name);
+
+	/**
+	 * @brief Read a string value (<name value="..." />)
+	 * @param group			Parent element
+	 * @param name			Value name
+	 * @return the value, or an empty string
+	 **/
+	static String readString(tinyxml2::XMLElement* group, const char* name);
+
+
+protected:
+
+	// One template to parse
+	struct Job
+	{
+		String name;
+		String file;
+		TemplateParser parser;
+		Template* result;
+	};
+
+	/**
+	 * @brief Worker thread : parse jobs until none are left
+	 * @param jobs			Job list
+	 * @param next			Next job index, shared by all workers
+	 **/
+	static void parseJobs(Ogre::vector<Job>::type* jobs, std::atomic<size_t>* next);
+
+
+protected:
+
+	// Data
+	String mPath;
+	Ogre::map<String, TemplateParser>::type mParsers;
+	Ogre::map<String, Template*>::type mTemplates;
+
+};
+
+#endif /* __TEMPLATE_REGISTRY_H_ */
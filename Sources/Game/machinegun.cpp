@@ -8,9 +8,6 @@
 
 #include "Game/machinegun.hpp"
 #include "Game/ship.hpp"
-#include "Game/bullet.hpp"
-
-static int bulletId = 0;
 
 
 /*----------------------------------------------
@@ -24,17 +21,10 @@ MachineGun::MachineGun(Game* g, String name, Ship* parent, Vector3 location, Qua
 
 void MachineGun::fire()
 {
-	
-	
 	float bulletSpeed = 600;
 
-	
-
 	Vector3 bulletLocation = mShip->getGlobalPosition(getLocation() + getRotation() * (mTurretFirstOffset + mTurretFirstRotation * (mTurretSecondOffset  + mTurretSecondRotation * mBarrelOffset)));
 	Vector3 bulletVelocity = mShip->getSpeed() + mShip->getRotation() * getRotation() * mTurretFirstRotation * mTurretSecondRotation * Vector3(0, 0, - bulletSpeed);
 
-	Quaternion bulletRotation = mShip->getRotation() * getRotation() * mTurretFirstRotation * mTurretSecondRotation;
-
-	Bullet* bullet = new Bullet(mGame, mName + "_Bullet" + StringConverter::toString(bulletId++), this,  bulletLocation, bulletRotation, bulletVelocity );
-	
+	mGame->getProjectiles()->spawn(bulletLocation, bulletVelocity, 5.0f, 0.0004f, mShip->getPhysBody());
 }
@@ -10,6 +10,25 @@
 #include "Engine/game.hpp"
 #include "Engine/actor.hpp"
 #include "Game/pilot.hpp"
+#include "Game/shiptemplate.hpp"
+#include "Game/ship.hpp"
+
+#define GUNBENCH_RANGE		1000
+#define GUNBENCH_WARMUP		6.0f
+
+
+/*----------------------------------------------
+	Constructor
+----------------------------------------------*/
+
+OrbitSegment::OrbitSegment()
+{
+	earth = NULL;
+	bGunBenchmark = false;
+	mGunBenchmarkTime = 0;
+	mGunShip = NULL;
+	mGunTarget = NULL;
+}
 
 
 /*----------------------------------------------
@@ -23,7 +42,11 @@ void OrbitSegment::construct()
 	earth->setRotation(Quaternion(Radian(Degree(-90).valueRadians()), Vector3(1,0,0)));
 	earth->setLocation(Vector3(0, -2000000, 0));
 	earth->setScale(1500);
-	mScene->setSkyBox(true, "Sky");
+	earth->setStatic(true);
+	if (!isHeadless())
+	{
+		mScene->setSkyBox(true, "Sky");
+	}
 
 	// Sun
 	Ogre::Light* l1 = mScene->createLight();
@@ -31,12 +54,36 @@ void OrbitSegment::construct()
     l1->setDiffuseColour(1.95f, 1.95f, 1.95f);
     l1->setSpecularColour(1.95f, 1.95f, 1.95f);
 	l1->setDirection(1, -0.5f, -0.2f);
-	l1->setCastShadows(false);
+	l1->setCastShadows(true);
 
 	// Collision crate
 	MeshActor* crate = new MeshActor(this, "crate", "crate.mesh", "MI_Crate", true, 1.0f);
 	crate->setLocation(Vector3(0, 0, -50));
 	crate->commit();
+
+	// Gun benchmark : the target is in range of all the guns, they fire once aimed
+	mGunBenchmarkTime = 0;
+	if (bGunBenchmark)
+	{
+		mGunShip = new Ship(this, "GunShip", "Sovereign");
+		mGunShip->setLocation(Vector3(0, 2000, 0));
+		mGunTarget = new Ship(this, "GunTarget", "Sovereign");
+		mGunTarget->setLocation(Vector3(0, 2000, -GUNBENCH_RANGE));
+		mGunShip->setAimDirection(Vector3(0, 0, -1));
+	}
+}
+
+
+void OrbitSegment::setGunBenchmark(bool bNewGunBenchmark)
+{
+	bGunBenchmark = bNewGunBenchmark;
+}
+
+
+void OrbitSegment::setupTemplates()
+{
+	mTemplates->addParser("Ships/", &ShipTemplate::parse);
+	Game::setupTemplates();
 }
 
 
@@ -49,6 +96,12 @@ void OrbitSegment::setupPlayer()
 void OrbitSegment::tick(const Ogre::FrameEvent& evt)
 {
 	Game::tick(evt);
+
+	if (bGunBenchmark)
+	{
+		mGunBenchmarkTime += evt.timeSinceLastFrame;
+		mGunShip->setFireOrder(mGunBenchmarkTime > GUNBENCH_WARMUP);
+	}
 	
 	earth->rotate(Quaternion(Radian(Degree(-0.1f * evt.timeSinceLastFrame).valueRadians()), Vector3(0,1,0)));
 }
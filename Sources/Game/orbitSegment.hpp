@@ -16,8 +16,27 @@
 Class definition
 ----------------------------------------------*/
 
+class Ship;
+
 class OrbitSegment : public Game
 {
+
+public:
+
+	/**
+	 * @brief Create the level
+	 **/
+	OrbitSegment();
+
+	/**
+	 * @brief Setup the gun benchmark : a ship fires all its guns at a target ship
+	 * @param bNewGunBenchmark	New state
+	 **/
+	void setGunBenchmark(bool bNewGunBenchmark);
+
+
+protected:
+
 	/**
 	 * @brief Level construction
 	 **/
@@ -33,6 +52,11 @@ class OrbitSegment : public Game
 	 **/
 	void setupPlayer();
 	
+	/**
+	 * @brief Register the game templates
+	 **/
+	void setupTemplates();
+	
 	/**
 	 * @brief Main tick event
 	 * @param evt				Frame event
@@ -45,6 +69,12 @@ protected:
 	// Earth mesh
 	MeshActor* earth;
 
+	// Gun benchmark
+	bool bGunBenchmark;
+	Real mGunBenchmarkTime;
+	Ship* mGunShip;
+	Ship* mGunTarget;
+
 };
 
 
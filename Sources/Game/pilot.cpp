@@ -24,6 +24,7 @@ const float TARGET_SPEED_INCREMENT = 0.1f;
 Pilot::Pilot(Game* g, String name) : Player(g, name)
 {
 	// Data
+	addTickGroups(TG_PRE);
 	mStepDistance = 5;
 	mHorizAngle = Degree(0);
 	mVertAngle = Degree(0);
@@ -37,7 +38,6 @@ Pilot::Pilot(Game* g, String name) : Player(g, name)
 	mShip = new Ship(g, "Ship", "Sovereign");
 	mShip->attachActor(this);
 	mShip->setLocation(Vector3(0, 0, 300));
-	mShip->saveToFile();
 	mDistance = mShip->getViewDistance();
 
 	// Camera setup
@@ -51,6 +51,10 @@ Pilot::Pilot(Game* g, String name) : Player(g, name)
 	
 void Pilot::preTick(const Ogre::FrameEvent& evt)
 {
+	if(!mCamera->getViewport()) {
+		return;
+	}
+
 	if(mInverted) {
 		Ogre::Ray ray = mCamera->getCameraToViewportRay(1.0 - mMouseState.X.abs / (float)mCamera->getViewport()->getActualWidth() , 1.0 - mMouseState.Y.abs / (float)mCamera->getViewport()->getActualHeight());
 		mShip->setAimDirection(-ray.getDirection());
@@ -34,37 +34,36 @@ Ship::Ship(Game* g, Ogre::String name, Ogre::String templateFile)
 	mSteerRoll = 0;
 	mSpeed = 0;
 	
-	// Load template file
-	loadTemplate(TEMPLATE_SHIP_DIR + templateFile + ".xml");
+	// Parsed template
+	mTemplate = static_cast<const ShipTemplate*>(g->getTemplates()->get(TEMPLATE_SHIP_DIR + templateFile));
+	assert(mTemplate != NULL && "Unknown ship template");
 
 	// Speed limits
-	setTemplateGroup("steering");
-	mMaxSpeed = loadFloatValue("linearSpeedLimit");
-	mMaxAngularSpeed = loadFloatValue("angularSpeedLimit");
-	mSoftModeLimit = loadFloatValue("linearSoftModeLimit");
-	mSoftModeAngularLimit = loadFloatValue("angularSoftModeLimit");
+	mMaxSpeed = mTemplate->maxSpeed;
+	mMaxAngularSpeed = mTemplate->maxAngularSpeed;
+	mSoftModeLimit = mTemplate->softModeLimit;
+	mSoftModeAngularLimit = mTemplate->softModeAngularLimit;
 
 	// Hull setup
-	setTemplateGroup("hull");
-	setModel(loadStringValue("mesh") + Ogre::String(".mesh"));
-	setMass(loadFloatValue("mass"));
-	setMaterial(loadStringValue("material"));
-	mViewDistance = loadFloatValue("viewDistance");
+	setModel(mTemplate->mesh);
+	setMass(mTemplate->mass);
+	setMaterial(mTemplate->material);
+	mViewDistance = mTemplate->viewDistance;
 
 	// Bonus data
-	setTemplateGroup("description");
-	mShipSize = loadIntValue("size");
-	mShipClass = loadStringValue("class");
-	mShipType = loadStringValue("type");
-	mShipStory = loadStringValue("story");
+	mShipSize = mTemplate->size;
+	mShipClass = mTemplate->shipClass;
+	mShipType = mTemplate->type;
+	mShipStory = mTemplate->story;
 
 	// External content
 	setupEngines();
 	setupWeapons();
 	setupAddons();
-	closeTemplate();
 
+	addTickGroups(TG_PRE);
 	commit();
+	setContinuousCollision(mTemplate->ccdMotionThreshold, mTemplate->ccdSweptSphereRadius);
 }
 
 
@@ -80,11 +79,8 @@ Ship::~Ship()
 void Ship::preTick(const Ogre::FrameEvent& evt)
 {
 	clearForces();
-}
-
 
-void Ship::tick(const Ogre::FrameEvent& evt)
-{
+	// Commands are ready before the parallel tick of the thrusters
 	Vector3 localSpeed = getLocalSpeed();
 	Vector3 localAngularSpeed = getLocalAngularSpeed();
 
@@ -95,8 +91,6 @@ void Ship::tick(const Ogre::FrameEvent& evt)
 	mCommandVector.x = computeSoftLinearCommand(localSpeed.x, 0.0f);
 	mCommandVector.y = computeSoftLinearCommand(localSpeed.y, 0.0f);
 	mCommandVector.z = computeSoftLinearCommand(localSpeed.z, mSpeed);
-
-	MeshActor::tick(evt);
 }
 
 
@@ -106,17 +100,13 @@ void Ship::tick(const Ogre::FrameEvent& evt)
 
 void Ship::setupEngines()
 {
-	setTemplateGroup("engines");
-	tinyxml2::XMLElement* i = mSaveGroup->FirstChildElement("engine");
-
-	while (i != NULL)
+	for (size_t i = 0; i < mTemplate->engines.size(); i++)
 	{
-		// Parse data
-		Vector3 engineLocation = Ogre::StringConverter::parseVector3(i->Attribute("location"));
-		Quaternion engineRotation = directionFromString(i->Attribute("direction"));
+		Vector3 engineLocation = mTemplate->engines[i].location;
+		Quaternion engineRotation = mTemplate->engines[i].rotation;
 
 		// Add a thruster
-		if (i->Attribute("type") == Ogre::String("thruster"))
+		if (mTemplate->engines[i].bThruster)
 		{
 			Thruster* engine = new Thruster(mGame, mName + "_Eng" + StringConverter::toString(mThrusters.size()), this, engineLocation, engineRotation);
 			mThrusters.push_back(engine);
@@ -132,7 +122,6 @@ void Ship::setupEngines()
 			mainengine->setLocation(engineLocation);
 			this->attachActor(mainengine);
 		}
-		i = i->NextSiblingElement("engine");
 	}
 }
 
@@ -342,6 +331,7 @@ float Ship::computeSoftAngularCommand(float measure, float command)
 void Ship::setSpeed(float speed)
 {
 	mSpeed = Math::Clamp(speed, MIN_SPEED_RATIO, MAX_SPEED_RATIO);
+	wake();
 }
 
 
@@ -349,12 +339,14 @@ void Ship::setSteer(float x, float y)
 {
 	mSteerX = Math::Clamp(x, -1.f, 1.f);
 	mSteerY = Math::Clamp(y, -1.f, 1.f);
+	wake();
 }
 
 
 void Ship::setRoll(float roll)
 {
 	mSteerRoll = Math::Clamp(roll, -20.0f, 20.0f);
+	wake();
 }
 
 
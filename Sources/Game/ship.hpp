@@ -10,6 +10,7 @@
 
 #include "Engine/meshactor.hpp"
 #include "Game/weapon.hpp"
+#include "Game/shiptemplate.hpp"
 
 class Game;
 class Thruster;
@@ -38,16 +39,10 @@ public:
 	virtual ~Ship();
 	
 	/**
-	 * @brief Pre-tick event
+	 * @brief Pre-tick event, computes the steering commands
 	 * @param evt			Frame event
 	 **/
 	void preTick(const Ogre::FrameEvent& evt);
-	
-	/**
-	 * @brief Main tick event
-	 * @param evt			Frame event
-	 **/
-	void tick(const Ogre::FrameEvent& evt);
 
 	/**
 	 * @brief Set the ship speed target
@@ -168,6 +163,7 @@ protected:
 	float mSoftModeAngularLimit;
 
 	// Customisation characteristics
+	const ShipTemplate* mTemplate;
 	float mViewDistance;
 	int mShipSize;
 	Ogre::String mShipClass;
@@ -0,0 +1,59 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#include "Game/shiptemplate.hpp"
+#include "Engine/savable.hpp"
+
+
+/*----------------------------------------------
+	Parser
+----------------------------------------------*/
+
+Template* ShipTemplate::parse(tinyxml2::XMLElement* root)
+{
+	ShipTemplate* t = new ShipTemplate();
+	tinyxml2::XMLElement* group;
+
+	// Speed limits
+	group = root->FirstChildElement("steering");
+	t->maxSpeed = TemplateRegistry::readFloat(group, "linearSpeedLimit");
+	t->maxAngularSpeed = TemplateRegistry::readFloat(group, "angularSpeedLimit");
+	t->softModeLimit = TemplateRegistry::readFloat(group, "linearSoftModeLimit");
+	t->softModeAngularLimit = TemplateRegistry::readFloat(group, "angularSoftModeLimit");
+
+	// Hull setup
+	group = root->FirstChildElement("hull");
+	t->mesh = TemplateRegistry::readString(group, "mesh") + ".mesh";
+	t->material = TemplateRegistry::readString(group, "material");
+	t->mass = TemplateRegistry::readFloat(group, "mass");
+	t->viewDistance = TemplateRegistry::readFloat(group, "viewDistance");
+	t->ccdMotionThreshold = TemplateRegistry::readFloat(group, "ccdMotionThreshold");
+	t->ccdSweptSphereRadius = TemplateRegistry::readFloat(group, "ccdSweptSphereRadius");
+
+	// Bonus data
+	group = root->FirstChildElement("description");
+	t->size = TemplateRegistry::readInt(group, "size");
+	t->shipClass = TemplateRegistry::readString(group, "class");
+	t->type = TemplateRegistry::readString(group, "type");
+	t->story = TemplateRegistry::readString(group, "story");
+
+	// Engines
+	group = root->FirstChildElement("engines");
+	tinyxml2::XMLElement* i = group ? group->FirstChildElement("engine") : NULL;
+	while (i != NULL)
+	{
+		ShipEngine engine;
+		engine.location = StringConverter::parseVector3(i->Attribute("location"));
+		engine.rotation = Savable::directionFromString(i->Attribute("direction"));
+		const char* type = i->Attribute("type");
+		engine.bThruster = (type != NULL && String(type) == "thruster");
+		t->engines.push_back(engine);
+		i = i->NextSiblingElement("engine");
+	}
+
+	return t;
+}
@@ -0,0 +1,67 @@
+/**
+* This work is distributed under the General Public License,
+* see LICENSE for details
+*
+* @author Gwennal ARBONA
+**/
+
+#ifndef __SHIP_TEMPLATE_H_
+#define __SHIP_TEMPLATE_H_
+
+#include "Engine/templateregistry.hpp"
+
+
+/*----------------------------------------------
+	Class definitions
+----------------------------------------------*/
+
+struct ShipEngine
+{
+	Vector3 location;
+	Quaternion rotation;
+	bool bThruster;
+};
+
+class ShipTemplate : public Template
+{
+
+public:
+
+	/**
+	 * @brief Parse a ship template (TemplateParser)
+	 * @param root			<template> element
+	 * @return the new template
+	 **/
+	static Template* parse(tinyxml2::XMLElement* root);
+
+
+public:
+
+	// Steering characteristics
+	float maxSpeed;
+	float maxAngularSpeed;
+	float softModeLimit;
+	float softModeAngularLimit;
+
+	// Hull
+	String mesh;
+	String material;
+	float mass;
+	float viewDistance;
+
+	// Continuous collision detection
+	float ccdMotionThreshold;
+	float ccdSweptSphereRadius;
+
+	// Description
+	int size;
+	String shipClass;
+	String type;
+	String story;
+
+	// Engines
+	Ogre::vector<ShipEngine>::type engines;
+
+};
+
+#endif /* __SHIP_TEMPLATE_H_ */
@@ -35,14 +35,17 @@ Thruster::Thruster(Game* g, String name, MeshActor* parent, Vector3 location, Qu
 	
 	// Position
 	mRelPosition = location;
+	mDirection = Vector3::ZERO;
+	mOutput = 0;
 	mShip = (Ship*)parent;
+	addTickGroups(TG_PARALLEL | TG_MAIN);
 	rotate(rotation);
 	setLocation(location);
 	parent->attachActor(this);
 }
 
 
-void Thruster::tick(const Ogre::FrameEvent& evt)
+void Thruster::parallelTick(const Ogre::FrameEvent& evt)
 {
 	// Basic data
 	Vector3 direction = mNode->getOrientation() * Vector3(0, 0, -1);
@@ -68,14 +71,19 @@ void Thruster::tick(const Ogre::FrameEvent& evt)
 	// Final output calculation
 	alpha *= mRotationRatio;
 	alpha += target.dotProduct(direction);
-	alpha = Math::Clamp(alpha, 0.0f, 1.0f);
+	mOutput = Math::Clamp(alpha, 0.0f, 1.0f);
+	mDirection = direction;
+	mShip->applyLocalForce(mOutput * mStrength * mDirection, mRelPosition);
+	setMaterialParam(1, mOutput);
+}
+
 
+void Thruster::tick(const Ogre::FrameEvent& evt)
+{
 	// Output
-	setMaterialParam(1, alpha);
-	float lightAlpha = Math::Clamp(10 * alpha, 0.0f, 3.0f);
+	float lightAlpha = Math::Clamp(10 * mOutput, 0.0f, 3.0f);
 	mLight->setDiffuseColour(lightAlpha * Ogre::ColourValue(0.2f, 0.9f, 1.0f));
 	mLight->setSpecularColour(lightAlpha * Ogre::ColourValue(0.2f, 0.9f, 1.0f));
-	mShip->applyLocalForce(alpha * mStrength * direction, mRelPosition);
 	MeshActor::tick(evt);
 }
 
@@ -34,7 +34,13 @@ public:
 	Thruster(Game* g, String name, MeshActor* parent, Vector3 location, Quaternion rotation);
 	
 	/**
-	 * @brief Main tick event
+	 * @brief Parallel tick event, computes and pushes the thruster output
+	 * @param evt			Frame event
+	 **/
+	void parallelTick(const Ogre::FrameEvent& evt);
+	
+	/**
+	 * @brief Main tick event, updates the exhaust effects
 	 * @param evt			Frame event
 	 **/
 	void tick(const Ogre::FrameEvent& evt);
@@ -60,8 +66,10 @@ protected:
 	Ogre::Light *mLight;
 	
 	Vector3 mRelPosition;
+	Vector3 mDirection;
 	float mRotationRatio;
 	float mStrength;
+	float mOutput;
 
 };
 
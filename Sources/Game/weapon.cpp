@@ -18,6 +18,8 @@ Weapon::Weapon(Game* g, String name, Ship* parent, Vector3 location, Quaternion
 	: ComponentActor(g, name, "canon_base.mesh", "White")
 {
 	mFiring = false;
+	mFireNow = false;
+	addTickGroups(TG_PARALLEL | TG_MAIN);
 	mTimeSinceLastFire = 0;
 	mFirerate = 0.05f; // 50 ms or 1200 rpm
 
@@ -73,7 +75,7 @@ static Radian normalizeAngle(Radian angle) {
 	return result;
 }
 
-void Weapon::tick(const Ogre::FrameEvent& evt)
+void Weapon::parallelTick(const Ogre::FrameEvent& evt)
 {
 	mTimeSinceLastFire += evt.timeSinceLastFrame;
 
@@ -135,9 +137,6 @@ void Weapon::tick(const Ogre::FrameEvent& evt)
 	mTurretFirstRotation.FromAngleAxis(nextFirstAngle, Vector3(0,0,1));
 	mTurretSecondRotation.FromAngleAxis(nextSecondAngle, Vector3(1,0,0));
 
-	mTurretActor->setRotation(mTurretFirstRotation);
-	mBarrelActor->setRotation(mTurretSecondRotation);
-
 	//gameLog("mAimDirection=" + StringConverter::toString(mAimDirection));
 	//gameLog("localAimDirection=" + StringConverter::toString(localAimDirection));
 	//gameLog("currentFirstAngle=" + StringConverter::toString(currentFirstAngle.valueDegrees()));
@@ -151,17 +150,34 @@ void Weapon::tick(const Ogre::FrameEvent& evt)
 	//gameLog("diffFirstAngle=" + StringConverter::toString(diffFirstAngle.valueDegrees()));
 	//gameLog("diffSecondAngle=" + StringConverter::toString(diffSecondAngle.valueDegrees()));
 
+	// Fire decision, the projectile is spawned in tick()
+	mFireNow = false;
 	if(mFiring) {
 		if(mTimeSinceLastFire >= mFirerate) {
-			//Fire
 			mTimeSinceLastFire = 0;
-			fire();
+			mFireNow = true;
 		}
 	}
+}
+
+
+void Weapon::tick(const Ogre::FrameEvent& evt)
+{
+	mTurretActor->setRotation(mTurretFirstRotation);
+	mBarrelActor->setRotation(mTurretSecondRotation);
+
+	if(mFireNow) {
+		fire();
+	}
 
 	ComponentActor::tick(evt);
 }
 
+bool Weapon::isAwake()
+{
+	return true;
+}
+
 void Weapon::setFireOrder(bool fire)
 {
 	mFiring = fire;
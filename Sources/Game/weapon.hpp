@@ -34,11 +34,23 @@ public:
 	Weapon(Game* g, String name, Ship* parent, Vector3 location, Quaternion rotation);
 	
 	/**
-	 * @brief Main tick event
+	 * @brief Parallel tick event, aims the turret
+	 * @param evt			Frame event
+	 **/
+	void parallelTick(const Ogre::FrameEvent& evt);
+	
+	/**
+	 * @brief Main tick event, moves the turret and fires
 	 * @param evt			Frame event
 	 **/
 	void tick(const Ogre::FrameEvent& evt);
 
+	/**
+	 * @brief The turret keeps aiming and firing while the ship sleeps
+	 * @return true
+	 **/
+	virtual bool isAwake();
+
 	/**
 	 * @brief Order the weapon to fire
 	 * @param fire		activate or disable fire
@@ -56,6 +68,7 @@ protected:
 	Vector3 mRelPosition;
 	float mRotationRatio;
 	bool mFiring;
+	bool mFireNow;
 	Real mFirerate;
 	Real mTimeSinceLastFire;
 	Vector3 mAimDirection;
@@ -7,6 +7,8 @@
 
 #include "Game/orbitSegment.hpp"
 #include "Editor/editor.hpp"
+#include "Engine/hullbaker.hpp"
+#include "Engine/Rendering/lightcluster.hpp"
 
 
 /*----------------------------------------------
@@ -18,14 +20,89 @@
 #   include "windows.h"
 	INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR strCmdLine, INT)
 #else
-	int main(int /*argc*/, char **/*argv*/)
+	int main(int argc, char **argv)
 #endif
 {
+	Ogre::StringVector args;
+
+	// Command line
+#if OGRE_PLATFORM == PLATFORM_WIN32 || OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+	args = StringUtil::split(strCmdLine, " ");
+#else
+	for (int i = 1; i < argc; i++)
+	{
+		args.push_back(argv[i]);
+	}
+#endif
+
+	// Offline collision baking : --bake [content folder]
+	for (size_t i = 0; i < args.size(); i++)
+	{
+		if (args[i] == "--bake")
+		{
+			String path = "Content/Game";
+			if (i + 1 < args.size())
+			{
+				path = args[i + 1];
+			}
+			return bakeHulls(path);
+		}
+	}
+
+	// Light binning benchmark and check : --lightbench [lights], non-zero on a binning mismatch
+	for (size_t i = 0; i < args.size(); i++)
+	{
+		if (args[i] == "--lightbench")
+		{
+			int lights = 10000;
+			if (i + 1 < args.size())
+			{
+				lights = StringConverter::parseInt(args[i + 1]);
+			}
+			return benchmarkLightCluster(lights);
+		}
+	}
 
 	// Open the world
 	OrbitSegment w;
 	//Editor w;
 
+	// Headless simulation : --headless [simulated seconds]
+	for (size_t i = 0; i < args.size(); i++)
+	{
+		if (args[i] == "--headless")
+		{
+			Real duration = 0;
+			if (i + 1 < args.size())
+			{
+				duration = StringConverter::parseReal(args[i + 1]);
+			}
+			w.setHeadless(true, duration);
+		}
+	}
+
+	// Physics backend : --physics [sequential|multithreaded], --physbench [rigid bodies]
+	for (size_t i = 0; i + 1 < args.size(); i++)
+	{
+		if (args[i] == "--physics")
+		{
+			w.setPhysicsBackend(args[i + 1]);
+		}
+		else if (args[i] == "--physbench")
+		{
+			w.setPhysicsBenchmark(StringConverter::parseInt(args[i + 1]));
+		}
+	}
+
+	// Gun benchmark : --gunbench, with --headless to get the hit report
+	for (size_t i = 0; i < args.size(); i++)
+	{
+		if (args[i] == "--gunbench")
+		{
+			w.setGunBenchmark(true);
+		}
+	}
+
 	try {
 		w.run();
 	}